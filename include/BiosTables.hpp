@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// PLDM BIOS Control and Configuration (DSP0247) responder. Serves the string,
+// attribute and attribute value tables with GetBIOSTable in multipart
+// transfers, and answers SetBIOSAttributeCurrentValue and
+// GetBIOSAttributeCurrentValueByHandle.
+//
+// The tables are encoded once, with pad and CRC-32, when the responder is
+// created. A set rewrites the entry in the encoded value table and only
+// marks its checksum stale; pad and checksum are redone when the next
+// transfer of the table starts. A transfer in progress keeps the table it
+// started with, the value table is copied on write while one is.
+class BiosTableResponder : public Responder
+{
+  public:
+    struct Attribute
+    {
+        enum class Type : uint8_t
+        {
+            enumeration = 0x00,
+            string = 0x01,
+            integer = 0x03
+        };
+
+        std::string name;
+        Type type = Type::enumeration;
+        // Enumeration
+        std::vector<std::string> values;
+        uint8_t defaultIndex = 0;
+        // String
+        uint16_t minLength = 0;
+        uint16_t maxLength = 64;
+        std::string defaultString;
+        // Integer
+        uint64_t lowerBound = 0;
+        uint64_t upperBound = 0;
+        uint32_t scalarIncrement = 1;
+        uint64_t defaultValue = 0;
+    };
+
+    struct Params
+    {
+        std::vector<Attribute> attributes;
+        // Attributes generated after the configured ones, to size the tables
+        // like those of a production BIOS
+        size_t generatedAttributes = 0;
+        // Table bytes per part of a multipart transfer
+        uint32_t transferSize = 1024;
+        int processingDelay = 1;
+    };
+
+    explicit BiosTableResponder(const Params& biosParams);
+
+    bool handles(const std::vector<uint8_t>& request) const override;
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    // Where the value of an attribute lives in the encoded value table, and
+    // what a new value is checked against
+    struct AttributeInfo
+    {
+        Attribute::Type type;
+        size_t valueOffset;
+        size_t valueSize;
+        uint8_t possibleValues;
+        uint16_t minLength;
+        uint16_t maxLength;
+        uint64_t lowerBound;
+        uint64_t upperBound;
+    };
+
+    static constexpr size_t tableCount = 3;
+    static constexpr size_t valueTable = 2;
+
+    Params params;
+    // String, attribute and attribute value tables, with pad and checksum
+    std::array<std::shared_ptr<std::vector<uint8_t>>, tableCount> tables;
+    // Table of the multipart transfer in progress, by table type
+    std::array<std::shared_ptr<const std::vector<uint8_t>>, tableCount>
+        transfers;
+    // Indexed by attribute handle
+    std::vector<AttributeInfo> attributeInfo;
+    // Value table length without pad and checksum
+    size_t valueTableSize = 0;
+    bool valueChecksumStale = false;
+
+    void buildTables();
+    std::vector<uint8_t>& writableValueTable();
+    uint8_t getTable(const std::vector<uint8_t>& request,
+                     std::vector<uint8_t>& out);
+    uint8_t setAttribute(const std::vector<uint8_t>& request);
+    uint8_t getAttribute(const std::vector<uint8_t>& request,
+                         std::vector<uint8_t>& out) const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Makes an endpoint answer "not ready" under load instead of just being slow.
+//
+// A request finds the endpoint busy when more than maxRequests arrived within
+// window, or at random with the given probability. Busy SPDM requests get
+// ERROR(ResponseNotReady) with the RDT exponent, RDTM and a token. Once RDT
+// has passed, RESPOND_IF_READY with that token is answered like the
+// original request. Busy PLDM requests get the configured completion code,
+// ERROR_NOT_READY unless told otherwise.
+//
+// Lives in the endpoint registry and is only used on the endpoint strand.
+class BusyModel
+{
+  public:
+    struct Params
+    {
+        double probability = 0;
+        // 0 disables the load trigger
+        uint32_t maxRequests = 0;
+        std::chrono::milliseconds window{100};
+        // RDT is 2^rdtExponent microseconds
+        uint8_t rdtExponent = 10;
+        uint8_t rdtm = 4;
+        uint8_t pldmCompletionCode = 0x04;
+        int notReadyDelay = 1;
+    };
+
+    struct Verdict
+    {
+        // Sent in place of the real response
+        std::optional<MctpResponse> notReady;
+        // Original request to answer in place of a RESPOND_IF_READY
+        std::optional<std::vector<uint8_t>> replay;
+    };
+
+    explicit BusyModel(const Params& busyParams);
+
+    Verdict intercept(const std::vector<uint8_t>& request);
+
+  private:
+    struct Deferred
+    {
+        std::vector<uint8_t> request;
+        std::chrono::steady_clock::time_point readyAt;
+    };
+
+    Params params;
+    std::deque<std::chrono::steady_clock::time_point> recent;
+    std::mt19937 random;
+    std::uniform_real_distribution<double> chance{0.0, 1.0};
+    // Deferred SPDM requests by token
+    std::unordered_map<uint8_t, Deferred> deferred;
+    uint8_t nextToken = 0;
+
+    bool busy();
+    Verdict spdm(const std::vector<uint8_t>& request);
+    MctpResponse spdmNotReady(const std::vector<uint8_t>& request,
+                              uint8_t requestCode, uint8_t token) const;
+    MctpResponse spdmError(const std::vector<uint8_t>& request,
+                           uint8_t errorCode) const;
+};
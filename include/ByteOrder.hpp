@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Little-endian fields of up to eight bytes, as PLDM, NVMe-MI and CXL messages
+// carry them
+uint64_t readLe(const uint8_t* data, size_t size);
+void writeLe(uint8_t* out, uint64_t value, size_t size);
+void appendLe(std::vector<uint8_t>& out, uint64_t value, size_t size);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Follows the D-Bus clients with method calls in progress by unique name and
+// cancels their waits once they leave the bus, so a crashed or restarted
+// requester leaves no timers or queued responses behind. A unique name is
+// gone for good when NameOwnerChanged reports it without a new owner, unique
+// names are never handed out twice.
+//
+// Only used from the D-Bus thread.
+class ClientTracker
+{
+  public:
+    using DepartureHandler = std::function<void(const std::string& client)>;
+
+    // A method call of client, in progress for the lifetime of the object
+    class Call
+    {
+      public:
+        Call(ClientTracker& clientTracker, const std::string& client);
+        Call(const Call&) = delete;
+        Call& operator=(const Call&) = delete;
+        ~Call();
+
+        // False once the client has left the bus
+        bool active() const;
+
+        // Waits on the io_context, cut short and false when the client
+        // leaves meanwhile
+        bool wait(std::chrono::milliseconds duration,
+                  boost::asio::yield_context& yield);
+
+      private:
+        ClientTracker& tracker;
+        std::string name;
+    };
+
+    // onDeparture is called for every unique name that leaves the bus, for
+    // dropping the work queued on its behalf
+    ClientTracker(sdbusplus::asio::connection& conn,
+                  DepartureHandler onDeparture);
+    ClientTracker() = delete;
+    ClientTracker(const ClientTracker&) = delete;
+    ClientTracker& operator=(const ClientTracker&) = delete;
+
+  private:
+    struct Client
+    {
+        size_t calls = 0;
+        bool departed = false;
+        std::unordered_set<boost::asio::steady_timer*> waits;
+    };
+
+    boost::asio::io_context& ioContext;
+    // Only clients with calls in progress
+    std::unordered_map<std::string, Client> clients;
+    DepartureHandler departure;
+    std::unique_ptr<sdbusplus::bus::match::match> ownerMatch;
+
+    void nameOwnerChanged(sdbusplus::message::message& msg);
+};
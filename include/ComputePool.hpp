@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Work-stealing pool for CPU heavy response generation.
+//
+// Each worker owns a deque: it pushes and pops its own work at the back and,
+// when idle, steals from the front of the others. Work submitted from outside
+// the pool is spread round robin. Results are delivered on the io_context of
+// the D-Bus connection, so a slow responder never holds up the strands or the
+// D-Bus thread.
+class ComputePool
+{
+  public:
+    ComputePool(boost::asio::io_context& ioc, unsigned threads);
+    ComputePool() = delete;
+    ComputePool(const ComputePool&) = delete;
+    ComputePool& operator=(const ComputePool&) = delete;
+    ~ComputePool();
+
+    // Runs work() on the pool and completes token with its result. A throwing
+    // work() is logged and completes with a value initialized result.
+    template <typename Work, typename CompletionToken>
+    auto run(Work&& work, CompletionToken&& token)
+    {
+        using Result = std::invoke_result_t<Work>;
+        return boost::asio::async_initiate<CompletionToken, void(Result)>(
+            [this](auto handler, auto&& job) {
+                auto resultExecutor = boost::asio::get_associated_executor(
+                    handler, ioContext.get_executor());
+                using Job = std::decay_t<decltype(job)>;
+                using Handler = decltype(handler);
+                using Guard = decltype(boost::asio::make_work_guard(
+                    resultExecutor));
+                // Tasks are std::function, so the move-only parts are shared
+                auto state = std::make_shared<std::tuple<Job, Handler, Guard>>(
+                    std::forward<decltype(job)>(job), std::move(handler),
+                    boost::asio::make_work_guard(resultExecutor));
+                submit([state]() {
+                    Result result{};
+                    try
+                    {
+                        result = std::get<0>(*state)();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        logTaskFailure(e);
+                    }
+                    auto ex = std::get<2>(*state).get_executor();
+                    boost::asio::post(ex, [state, result = std::move(
+                                                      result)]() mutable {
+                        std::get<1>(*state)(std::move(result));
+                        std::get<2>(*state).reset();
+                    });
+                });
+            },
+            token, std::forward<Work>(work));
+    }
+
+    void submit(std::function<void()> task);
+
+  private:
+    struct alignas(64) Worker
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    boost::asio::io_context& ioContext;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> submitCursor{0};
+    std::atomic<size_t> queued{0};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static void logTaskFailure(const std::exception& e);
+    bool popLocal(size_t index, std::function<void()>& task);
+    bool steal(size_t thief, std::function<void()>& task);
+    void workerLoop(size_t index);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <functional>
+#include <string>
+
+// Watches a single configuration file with inotify and invokes the callback
+// once the file settles. The parent directory is watched rather than the file
+// itself so that editors which replace the file through a rename are handled.
+class ConfigWatcher
+{
+  public:
+    ConfigWatcher(boost::asio::io_context& ioc, const std::string& file,
+                  std::function<void()> callback);
+    ConfigWatcher() = delete;
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+    ~ConfigWatcher();
+
+  private:
+    std::string fileName;
+    std::function<void()> onChange;
+    int inotifyFd = -1;
+    int watchFd = -1;
+    boost::asio::posix::stream_descriptor inotifyConn;
+    boost::asio::steady_timer settleTimer;
+    std::array<char, 4096> readBuf;
+
+    void waitForEvents();
+    void scheduleReload();
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (ISO 3309, reflected polynomial 0xEDB88320) as used by PLDM. Pass
+// the result of the previous call as crc to continue over more data.
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+// CRC-32C (Castagnoli, reflected polynomial 0x82F63B78), the NVMe-MI message
+// integrity check. Continued the same way. Uses the SSE 4.2 crc32
+// instruction when the CPU has it.
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc = 0);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// MCTP message types of the CXL bindings (DSP0234)
+constexpr uint8_t mctpMsgTypeCxlFmApi = 0x07;
+constexpr uint8_t mctpMsgTypeCxlCci = 0x08;
+
+// Generated CXL type 3 memory expander answering CCI and FM-API messages:
+// Identify, Get/Set Response Message Limit, Get/Set Timestamp, Get Supported
+// Logs, Get Log, Identify Memory Device and Get Health Info. Besides the
+// Command Effects Log the device has a vendor debug log of any size, which
+// is generated on the fly so that large offset/length transfers cost no
+// memory.
+class CxlDeviceResponder : public Responder
+{
+  public:
+    struct Params
+    {
+        uint16_t vendorId = 0x8086;
+        uint16_t deviceId = 0x0D93;
+        uint16_t subsystemVendorId = 0x8086;
+        uint16_t subsystemId = 0x0000;
+        uint64_t serialNumber = 0;
+        std::string firmwareRevision = "1.0.0";
+        // In 256 MiB units
+        uint64_t capacity = 64;
+        uint8_t healthStatus = 0;
+        uint8_t mediaStatus = 0;
+        uint8_t lifeUsed = 0;
+        int16_t temperature = 35;
+        uint32_t dirtyShutdownCount = 0;
+        uint32_t vendorLogSize = 1024 * 1024;
+        int processingDelay = 1;
+    };
+
+    explicit CxlDeviceResponder(const Params& deviceParams);
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    Params params;
+    // 2^n bytes, set with Set Response Message Limit
+    uint8_t responseLimit = 12;
+    // Timestamp set by the host and when, zero until set
+    uint64_t timestampBase = 0;
+    std::chrono::steady_clock::time_point timestampSetAt;
+
+    uint16_t getLog(const std::vector<uint8_t>& input,
+                    std::vector<uint8_t>& output, bool& deferred) const;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "DeviceCoroutine.hpp"
+
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Device coroutines by name, for endpoints to pick in endpoints.json. Every
+// endpoint entry starts an instance of its own, so no state is shared between
+// endpoints. Devices written in code are added before the endpoints are
+// loaded, afterwards the catalog is only read.
+//
+// Built in:
+// - "Counter" answers every request with its first two bytes and a running
+//   count. Params: "Delay" in milliseconds.
+// - "Sequence" answers the requests with "Responses" in turn, over and over.
+//   Each response is the full payload, message type included, or null for a
+//   request that goes unanswered. Params: "Responses", "Delay".
+class DeviceCatalog
+{
+  public:
+    // Params come from the endpoint config. Throws json::exception when they
+    // don't fit the device.
+    using Factory =
+        std::function<DeviceCoroutine(const nlohmann::json& params)>;
+
+    DeviceCatalog();
+
+    void add(std::string name, Factory factory);
+
+    // nullopt for an unknown device
+    std::optional<DeviceCoroutine> create(const std::string& name,
+                                          const nlohmann::json& params) const;
+
+  private:
+    std::unordered_map<std::string, Factory> factories;
+};
+
+extern DeviceCatalog deviceCatalog;
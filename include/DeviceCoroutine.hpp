@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Emulated devices written as C++20 coroutines. A device runs on the strand
+// of its endpoint and is resumed in place by every request routed to it, so
+// there is no scheduling beyond the strand and each device costs one
+// coroutine frame:
+//
+//     DeviceCoroutine counter()
+//     {
+//         uint8_t count = 0;
+//         for (;;)
+//         {
+//             const auto& request = co_await nextRequest();
+//             co_await delay(std::chrono::milliseconds(5));
+//             std::vector<uint8_t> response{request[0], request[1], ++count};
+//             co_yield response;
+//         }
+//     }
+//
+//     deviceCatalog.add("Counter",
+//                       [](const nlohmann::json&) { return counter(); });
+//
+// co_await nextRequest() hands out the current request, message type byte
+// included. The reference is only valid until the coroutine suspends next.
+// co_yield sends a response. A request for which the device waits for the
+// next request without yielding gets no response. co_await delay(d) adds d to
+// the processing delay of the next response.
+struct NextRequest
+{};
+
+inline NextRequest nextRequest()
+{
+    return {};
+}
+
+struct Delay
+{
+    std::chrono::milliseconds duration;
+};
+
+inline Delay delay(std::chrono::milliseconds duration)
+{
+    return {duration};
+}
+
+class DeviceCoroutine
+{
+  public:
+    struct promise_type
+    {
+        const std::vector<uint8_t>* request = nullptr;
+        // Request handed out by nextRequest and not yet answered
+        bool requestTaken = false;
+        std::optional<MctpResponse> response;
+        int pendingDelay = 0;
+        std::exception_ptr failure;
+
+        DeviceCoroutine get_return_object()
+        {
+            return DeviceCoroutine(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // Started by the first request
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void()
+        {}
+        void unhandled_exception()
+        {
+            failure = std::current_exception();
+        }
+
+        std::suspend_always yield_value(std::vector<uint8_t> payload)
+        {
+            response = MctpResponse{pendingDelay, std::move(payload), {}};
+            pendingDelay = 0;
+            requestTaken = false;
+            return {};
+        }
+
+        auto await_transform(NextRequest)
+        {
+            struct Awaiter
+            {
+                promise_type& promise;
+
+                // Resumed by respond() with the request already in place
+                bool await_ready() const noexcept
+                {
+                    return promise.request != nullptr &&
+                           !promise.requestTaken;
+                }
+                void await_suspend(std::coroutine_handle<>) noexcept
+                {
+                    // The previous request goes unanswered
+                    promise.request = nullptr;
+                    promise.requestTaken = false;
+                    promise.pendingDelay = 0;
+                }
+                const std::vector<uint8_t>& await_resume() noexcept
+                {
+                    promise.requestTaken = true;
+                    return *promise.request;
+                }
+            };
+            return Awaiter{*this};
+        }
+
+        std::suspend_never await_transform(Delay wait)
+        {
+            pendingDelay += static_cast<int>(wait.duration.count());
+            return {};
+        }
+    };
+
+    DeviceCoroutine(DeviceCoroutine&& other) noexcept :
+        handle(std::exchange(other.handle, nullptr))
+    {}
+    DeviceCoroutine(const DeviceCoroutine&) = delete;
+    DeviceCoroutine& operator=(const DeviceCoroutine&) = delete;
+    DeviceCoroutine& operator=(DeviceCoroutine&&) = delete;
+    ~DeviceCoroutine()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    // Resumes the device with request and returns its response, if any
+    std::optional<MctpResponse> resume(const std::vector<uint8_t>& request);
+
+    bool done() const
+    {
+        return !handle || handle.done();
+    }
+
+  private:
+    explicit DeviceCoroutine(std::coroutine_handle<promise_type> coroutine) :
+        handle(coroutine)
+    {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Routes the requests of one or more message types of an endpoint to a
+// device coroutine. Once the device returns, its requests fall through to the
+// req_resp table.
+class CoroutineResponder : public Responder
+{
+  public:
+    explicit CoroutineResponder(DeviceCoroutine coroutine) :
+        device(std::move(coroutine))
+    {}
+
+    bool handles(const std::vector<uint8_t>&) const override
+    {
+        return !device.done();
+    }
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override
+    {
+        return device.resume(request);
+    }
+
+  private:
+    DeviceCoroutine device;
+};
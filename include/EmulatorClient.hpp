@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <string>
+#include <vector>
+
+// Client side of the emulator for test and load tools.
+//
+// Sends requests with SendMctpMessagePayload on one shared connection without
+// waiting for each other, and picks the responses out of
+// MessageReceivedSignal through a single narrow match. Outstanding requests
+// are kept in a table indexed by (EID, tag), so matching a response is a
+// single array access. Requests beyond the free tags of an endpoint wait in a
+// per-endpoint queue. Completions run on the io_context of the connection.
+class EmulatorClient
+{
+  public:
+    using Callback =
+        std::function<void(boost::system::error_code, std::vector<uint8_t>)>;
+
+    // Round trip latency of completed requests, in log2 microsecond buckets
+    struct LatencyStats
+    {
+        static constexpr size_t bucketCount = 32;
+
+        uint64_t completed = 0;
+        uint64_t timeouts = 0;
+        uint64_t errors = 0;
+        std::chrono::nanoseconds min = std::chrono::nanoseconds::max();
+        std::chrono::nanoseconds max = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+        std::array<uint64_t, bucketCount> histogram{};
+
+        std::chrono::nanoseconds mean() const;
+        // Upper bound of the bucket holding the given percentile (0-100)
+        std::chrono::microseconds percentile(double pct) const;
+    };
+
+    // tagMask selects the MCTP tags this client may use, so that several
+    // clients can drive the same endpoints without mixing up responses
+    EmulatorClient(std::shared_ptr<sdbusplus::asio::connection> conn,
+                   uint8_t tagMask = 0xFF,
+                   std::string service = "xyz.openbmc_project.mctp-emulator");
+    EmulatorClient() = delete;
+    EmulatorClient(const EmulatorClient&) = delete;
+    EmulatorClient& operator=(const EmulatorClient&) = delete;
+    ~EmulatorClient();
+
+    // Completes token with (error_code, response), e.g. a callback or
+    // yield[ec]. Times out with boost::asio::error::timed_out.
+    template <typename CompletionToken>
+    auto asyncSend(uint8_t dstEid, std::vector<uint8_t> payload,
+                   std::chrono::milliseconds timeout, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<
+            CompletionToken,
+            void(boost::system::error_code, std::vector<uint8_t>)>(
+            [this, dstEid, timeout](auto handler,
+                                    std::vector<uint8_t>&& request) {
+                // Callback is copyable, share the handler instead
+                auto shared =
+                    std::make_shared<decltype(handler)>(std::move(handler));
+                send(dstEid, std::move(request), timeout,
+                     [shared](boost::system::error_code ec,
+                              std::vector<uint8_t> response) {
+                         (*shared)(ec, std::move(response));
+                     });
+            },
+            token, std::move(payload));
+    }
+
+    void send(uint8_t dstEid, std::vector<uint8_t> payload,
+              std::chrono::milliseconds timeout, Callback callback);
+
+    size_t outstanding() const
+    {
+        return inFlight;
+    }
+    const LatencyStats& latency() const
+    {
+        return stats;
+    }
+    void resetLatency()
+    {
+        stats = LatencyStats{};
+    }
+
+  private:
+    static constexpr size_t tagCount = 8;
+
+    struct Request
+    {
+        uint8_t dstEid;
+        std::vector<uint8_t> payload;
+        std::chrono::milliseconds timeout;
+        Callback callback;
+    };
+
+    struct Slot
+    {
+        bool busy = false;
+        uint64_t generation = 0;
+        Callback callback;
+        std::chrono::steady_clock::time_point sent;
+        std::unique_ptr<boost::asio::steady_timer> timer;
+    };
+
+    std::shared_ptr<sdbusplus::asio::connection> connection;
+    std::string serviceName;
+    uint8_t allowedTags;
+    std::unique_ptr<sdbusplus::bus::match::match> responseMatch;
+    // Indexed by (EID << 3) | tag
+    std::vector<Slot> slots;
+    std::vector<std::deque<Request>> backlog;
+    size_t inFlight = 0;
+    LatencyStats stats;
+    // Handlers of timers and method calls still pending after destruction
+    // find this expired and leave the freed slots alone
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+
+    void dispatch(uint8_t dstEid, uint8_t tag, Request request);
+    void complete(size_t index, boost::system::error_code ec,
+                  std::vector<uint8_t> response);
+    void onResponse(sdbusplus::message::message& msg);
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "BusyModel.hpp"
+#include "Responder.hpp"
+
+#include <libmctp.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sdbusplus/asio/object_server.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using EndpointInterfaceMap =
+    std::unordered_map<mctp_eid_t,
+                       std::shared_ptr<sdbusplus::asio::dbus_interface>>;
+
+struct EndpointEntry
+{
+    std::shared_ptr<sdbusplus::asio::dbus_interface> interface;
+    // Code driven responders by MCTP message type, these take precedence
+    // over the req_resp tables
+    std::unordered_map<uint8_t, std::shared_ptr<Responder>> responders;
+    // Answers every message type, for the transport benchmark endpoint kinds
+    std::shared_ptr<Responder> anyType;
+    // Not ready behavior under load, null for an endpoint that is never busy
+    std::shared_ptr<BusyModel> busy;
+};
+
+using EndpointMap = std::unordered_map<mctp_eid_t, EndpointEntry>;
+
+// Read-mostly view of the live endpoints, shared by every request handler.
+//
+// Readers never block and never write to shared state: entering a read
+// section only stores the current epoch into a cache line owned by the
+// calling thread. Writers build a complete new map, publish it with a single
+// pointer swap and retire the old one. Retired maps are freed on a later
+// publish once no reader that could still see them is active.
+class EndpointRegistry
+{
+  public:
+    class ReadGuard
+    {
+      public:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard();
+
+        const EndpointMap& operator*() const
+        {
+            return *snapshot;
+        }
+        const EndpointMap* operator->() const
+        {
+            return snapshot;
+        }
+
+      private:
+        friend class EndpointRegistry;
+        explicit ReadGuard(const EndpointMap* map) : snapshot(map)
+        {
+        }
+        const EndpointMap* snapshot;
+    };
+
+    EndpointRegistry();
+    EndpointRegistry(const EndpointRegistry&) = delete;
+    EndpointRegistry& operator=(const EndpointRegistry&) = delete;
+    ~EndpointRegistry();
+
+    // Pins the current snapshot for the lifetime of the guard. Guards may
+    // nest on the same thread.
+    ReadGuard read() const;
+
+    // Replaces the snapshot seen by new readers
+    void publish(EndpointMap endpoints);
+
+    // Threads that may ever read, reading from one more throws
+    static constexpr size_t maxReaderThreads = 128;
+
+  private:
+    static constexpr uint64_t idleEpoch = 0;
+
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> epoch{idleEpoch};
+        std::atomic<bool> claimed{false};
+    };
+
+    struct ThreadSlot
+    {
+        ReaderSlot* slot = nullptr;
+        unsigned depth = 0;
+        ~ThreadSlot();
+    };
+
+    // One epoch domain for the whole process, like kernel RCU
+    static std::atomic<uint64_t> globalEpoch;
+    static std::array<ReaderSlot, maxReaderThreads> readerSlots;
+    static ThreadSlot& threadSlot();
+
+    std::atomic<const EndpointMap*> current;
+    std::mutex writeLock;
+    std::vector<std::pair<const EndpointMap*, uint64_t>> retired;
+
+    void reclaimLocked();
+};
+
+extern EndpointRegistry endpointRegistry;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "LinkTimingModel.hpp"
+#include "Responder.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Bridges the Ethernet over MCTP messages of one endpoint to a local TAP
+// device. Frames sent to the endpoint are written to the TAP device, frames
+// read from the TAP device are sent by the endpoint as MessageReceivedSignal.
+//
+// Both directions share the emulated link: a frame leaves once the frames
+// before it are through and its own wire time per the binding's timing model
+// has passed. Due frames are handled in batches, one timer wakeup and one
+// readiness event each drain as many frames as are ready.
+class EthernetBridge : public std::enable_shared_from_this<EthernetBridge>
+{
+  public:
+    // Gets each frame read from the TAP device, message type byte included
+    using FrameHandler = std::function<void(std::vector<uint8_t>)>;
+
+    // Throws std::system_error if the TAP device cannot be set up
+    EthernetBridge(boost::asio::io_context& ioc, const std::string& tapName,
+                   std::shared_ptr<const LinkTimingModel> link,
+                   FrameHandler toRequester);
+    EthernetBridge(const EthernetBridge&) = delete;
+    EthernetBridge& operator=(const EthernetBridge&) = delete;
+
+    void start();
+    // Stops bridging, pending frames are dropped
+    void close();
+
+    // Thread safe, the frame is handed to the io_context
+    void fromRequester(std::vector<uint8_t> frame);
+
+  private:
+    struct Frame
+    {
+        std::chrono::steady_clock::time_point due;
+        std::vector<uint8_t> bytes;
+    };
+
+    boost::asio::io_context& ioContext;
+    boost::asio::posix::stream_descriptor tap;
+    boost::asio::steady_timer linkTimer;
+    std::shared_ptr<const LinkTimingModel> linkModel;
+    FrameHandler onFrame;
+    // When the emulated link is free again
+    std::chrono::steady_clock::time_point linkBusyUntil;
+    std::deque<Frame> toTap;
+    std::deque<Frame> fromTap;
+    bool closed = false;
+
+    std::chrono::steady_clock::time_point scheduleOnLink(size_t bytes,
+                                                         bool fromEndpoint);
+    void waitForFrames();
+    void readFrames();
+    void flush();
+    void armTimer();
+};
+
+// Hands Ethernet over MCTP requests of an endpoint to its bridge. No
+// response is sent for them.
+class EthernetBridgeResponder : public Responder
+{
+  public:
+    explicit EthernetBridgeResponder(
+        std::shared_ptr<EthernetBridge> tapBridge) :
+        bridge(std::move(tapBridge))
+    {}
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    std::shared_ptr<EthernetBridge> bridge;
+};
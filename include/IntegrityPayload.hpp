@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Self-checking payloads of the Integrity endpoint kind, for proving that a
+// data path neither drops, corrupts nor reorders bytes at full rate without
+// comparing them against a golden copy. All fields are little endian:
+//
+//   message type, uint32 sequence, uint32 length of the whole payload,
+//   generated data, CRC-32C of everything before it
+//
+// The sequence counts the responses of an endpoint, starting at 0.
+struct IntegrityPayload
+{
+    static constexpr size_t sequenceOffset = 1;
+    static constexpr size_t lengthOffset = 5;
+    static constexpr size_t dataOffset = 9;
+    static constexpr size_t crcSize = 4;
+    static constexpr size_t minSize = dataOffset + crcSize;
+
+    // Payload of size bytes, at least minSize
+    static std::vector<uint8_t> make(uint8_t msgType, uint32_t sequence,
+                                     size_t size);
+};
+
+// Checks integrity payloads as they arrive, per endpoint. Responses of one
+// endpoint must be checked in the order they were received. Skipped sequence
+// numbers are remembered, one that shows up later is reordered rather than
+// missing.
+class IntegrityVerifier
+{
+  public:
+    enum class Result
+    {
+        ok,
+        // Length differs from its length field, or below the minimum
+        truncated,
+        // CRC mismatch
+        corrupted,
+        // Intact, but sequence numbers were skipped since the last one
+        gap,
+        // Intact, and one of the sequence numbers skipped earlier
+        reordered,
+        // Intact, but the endpoint counts from 0 again, it was recreated
+        restarted
+    };
+
+    struct Stats
+    {
+        uint64_t verified = 0;
+        uint64_t bytes = 0;
+        uint64_t truncated = 0;
+        uint64_t corrupted = 0;
+        // Sequence numbers skipped over and not seen since
+        uint64_t missing = 0;
+        uint64_t reordered = 0;
+        uint64_t restarts = 0;
+    };
+
+    Result check(uint8_t eid, const std::vector<uint8_t>& payload);
+
+    const Stats& stats() const
+    {
+        return counters;
+    }
+
+    // Also forgets the sequence numbers seen so far
+    void reset();
+
+  private:
+    // Run of skipped sequence numbers, modulo 2^32
+    struct Gap
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct Endpoint
+    {
+        std::optional<uint32_t> nextSequence;
+        // Oldest first. Beyond maxGaps the oldest are given up on, they
+        // stay missing.
+        std::vector<Gap> gaps;
+    };
+
+    static constexpr size_t maxGaps = 1024;
+
+    Stats counters;
+    std::array<Endpoint, 256> endpoints;
+
+    static void addGap(Endpoint& endpoint, uint32_t first, uint32_t count);
+    static bool fillGap(Endpoint& endpoint, uint32_t sequence);
+};
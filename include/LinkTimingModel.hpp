@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Time an MCTP message spends on the physical link of a binding, including
+// packetization into MTU sized packets and the medium specific framing.
+class LinkTimingModel
+{
+  public:
+    virtual ~LinkTimingModel() = default;
+
+    // bytes is the MCTP message as seen by upper layers, message type byte
+    // included. endpointInitiated is set for traffic from the endpoint to the
+    // bus owner, which on some media needs extra signalling.
+    virtual std::chrono::microseconds
+        transferTime(size_t bytes, bool endpointInitiated) const = 0;
+
+    // MCTP transport header of every packet
+    static constexpr size_t mctpHeaderSize = 4;
+
+  protected:
+    // Calls fn(packetBytes) for each MCTP packet of a message, transport
+    // header included
+    template <typename Fn>
+    static void forEachPacket(size_t bytes, size_t mtu, Fn&& fn)
+    {
+        do
+        {
+            size_t chunk = bytes < mtu ? bytes : mtu;
+            fn(mctpHeaderSize + chunk);
+            bytes -= chunk;
+        } while (bytes > 0);
+    }
+};
+
+// MCTP over I3C (DSP0233). Every packet is a private transfer with a PEC byte.
+// Endpoint initiated packets are announced with an In-Band Interrupt first.
+class I3CTimingModel : public LinkTimingModel
+{
+  public:
+    struct Params
+    {
+        // SDR or HDR-DDR
+        bool hdrDdr = false;
+        uint32_t clockHz = 12500000;
+        size_t mtu = 64;
+        // Controller reaction time to an IBI before it starts the read
+        uint32_t ibiLatencyUs = 10;
+    };
+
+    explicit I3CTimingModel(const Params& linkParams);
+    std::chrono::microseconds
+        transferTime(size_t bytes, bool endpointInitiated) const override;
+
+  private:
+    Params params;
+};
+
+// MCTP over USB (DSP0283). Each MCTP packet with its USB transport header is
+// one bulk transfer, split into max packet size USB packets. Transfers from
+// the device wait for the host to poll the bulk IN endpoint.
+class UsbTimingModel : public LinkTimingModel
+{
+  public:
+    struct Params
+    {
+        // High speed (480 Mb/s) or full speed (12 Mb/s)
+        bool highSpeed = true;
+        size_t maxPacketSize = 512;
+        size_t mtu = 508;
+        uint32_t transferOverheadUs = 20;
+        uint32_t inPollIntervalUs = 125;
+    };
+
+    explicit UsbTimingModel(const Params& linkParams);
+    std::chrono::microseconds
+        transferTime(size_t bytes, bool endpointInitiated) const override;
+
+  private:
+    Params params;
+};
+
+// MCTP over KCS (DSP0254). The host interface moves one byte per IBF/OBF
+// handshake, bracketed by WRITE_START/WRITE_END control codes. Endpoint
+// initiated packets wait for the host to notice the attention flag.
+class KcsTimingModel : public LinkTimingModel
+{
+  public:
+    struct Params
+    {
+        uint32_t byteLatencyUs = 10;
+        size_t mtu = 64;
+        uint32_t attentionLatencyUs = 100;
+    };
+
+    explicit KcsTimingModel(const Params& linkParams);
+    std::chrono::microseconds
+        transferTime(size_t bytes, bool endpointInitiated) const override;
+
+  private:
+    Params params;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+// Lua interpreter of one endpoint. The scripts of all message types and
+// commands of the endpoint run in it and keep their state between calls.
+// Like the responders using it, it is only touched from the endpoint strand.
+class LuaEndpointState
+{
+  public:
+    LuaEndpointState();
+    LuaEndpointState(const LuaEndpointState&) = delete;
+    LuaEndpointState& operator=(const LuaEndpointState&) = delete;
+    ~LuaEndpointState();
+
+    // Compiles script and runs its main chunk once, within instructionBudget
+    // like a call. The chunk returns the handler function(request,
+    // response), which returns the processing delay in milliseconds or nil
+    // for no response. Throws std::runtime_error.
+    int load(const std::string& script, int instructionBudget);
+
+    // Runs handler with request and response buffers that are views onto the
+    // C++ vectors, stopping the script once it exceeds instructionBudget
+    std::optional<MctpResponse> call(int handler,
+                                     const std::vector<uint8_t>& request,
+                                     int instructionBudget);
+
+  private:
+    lua_State* state;
+    // Registry references of the reused request and response buffers
+    int requestRef;
+    int responseRef;
+};
+
+// Dispatches requests of one message type to Lua scripts by command code
+class LuaResponder : public Responder
+{
+  public:
+    // Command byte offset in the payload (message type byte included), for
+    // message types with commands. Without one only a catch-all script works.
+    LuaResponder(std::shared_ptr<LuaEndpointState> luaState,
+                 std::optional<size_t> commandOffset);
+
+    // command nullopt handles every request without a script of its own
+    void addScript(std::optional<uint8_t> command, const std::string& script,
+                   int instructionBudget);
+
+    bool handles(const std::vector<uint8_t>& request) const override;
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+    // Default command byte offset for the MCTP message type, if it has one
+    static std::optional<size_t> defaultCommandOffset(uint8_t msgType);
+
+  private:
+    struct Handler
+    {
+        int ref;
+        int instructionBudget;
+    };
+
+    std::shared_ptr<LuaEndpointState> lua;
+    std::optional<size_t> offset;
+    std::unordered_map<uint8_t, Handler> commands;
+    std::optional<Handler> catchAll;
+
+    const Handler* find(const std::vector<uint8_t>& request) const;
+};
@@ -1,15 +1,19 @@
 #pragma once
 
+#include "ComputePool.hpp"
+#include "EndpointRegistry.hpp"
+#include "EthernetBridge.hpp"
+#include "LinkTimingModel.hpp"
+#include "PowerModel.hpp"
+#include "RequestEngine.hpp"
+#include "RequesterAnalyzer.hpp"
+#include "VendorRegistry.hpp"
+
 #include <libmctp.h>
 
+#include <nlohmann/json.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
-using EndpointInterfaceMap =
-    std::unordered_map<mctp_eid_t,
-                       std::shared_ptr<sdbusplus::asio::dbus_interface>>;
-
-extern EndpointInterfaceMap endpointInterface;
-
 extern std::shared_ptr<sdbusplus::asio::connection> bus;
 
 
@@ -22,24 +26,161 @@ enum class bindType
     usb = 0x03,
     kcs = 0x04,
     serial = 0x05,
+    i3c = 0x06,
     vendorDefined = 0xFF
 };
 
+// Endpoint description as parsed from the endpoints json files. This is the
+// live model that hot reloads are diffed against.
+struct EndpointConfig
+{
+    mctp_eid_t eid;
+    std::string uuid;
+    std::string mode;
+    uint16_t networkId;
+    bool mctpControl;
+    bool pldm;
+    bool ncsi;
+    bool ethernet;
+    bool nvmeMgmtMsg;
+    bool spdm;
+    bool securedMsg;
+    bool vdpci;
+    bool vdiana;
+    bool cxlFmApi;
+    bool cxlCci;
+    std::vector<uint16_t> vdpciCapabilitySets;
+    nlohmann::json additionalInterfaces;
+    // Lua scripts answering requests of this endpoint
+    nlohmann::json luaResponders;
+    // Device coroutines from the device catalog answering requests of this
+    // endpoint
+    nlohmann::json devices;
+    // Parameters of a generated CXL device answering CXL messages
+    nlohmann::json cxlDevice;
+    // Parameters of a generated NC-SI controller answering NC-SI messages
+    nlohmann::json ncsiDevice;
+    // TAP device Ethernet over MCTP frames are bridged to, if any
+    std::string ethernetTap;
+    // Not ready behavior of SPDM and PLDM under load
+    nlohmann::json busy;
+    // Power states and wake penalties
+    nlohmann::json power;
+    // PLDM effecters and sensors backed by a plant model
+    nlohmann::json plant;
+    // PLDM numeric sensors played back from a recorded time series
+    nlohmann::json timeSeries;
+    // PLDM BIOS string, attribute and attribute value tables
+    nlohmann::json biosTables;
+    // NVMe drive behind NVMe-MI Admin command tunneling
+    nlohmann::json nvmeDevice;
+    // Transport benchmark kind, "Echo" or "Sized", empty for a regular
+    // endpoint, and its response delay in milliseconds
+    std::string kind;
+    int kindDelay;
+    // json file the endpoint was added from
+    std::string source;
+};
+
+// Packed endpoint record returned by GetEndpoints: network ID, EID, mode, UUID,
+// message type bitmask (bit n is the nth SupportedMessageTypes property) and
+// VDPCI capability sets
+using EndpointRecord = std::tuple<uint16_t, mctp_eid_t, std::string,
+                                  std::string, uint32_t, std::vector<uint16_t>>;
+
 class MctpBinding
 {
   public:
     MctpBinding(std::shared_ptr<sdbusplus::asio::object_server>& objServer,
-                std::string& objPath);
+                std::string& objPath, unsigned workerThreads,
+                unsigned computeThreads);
     MctpBinding() = delete;
     void addEndpoints(std::string file, std::optional<uint8_t> destId = std::nullopt);
+    void reloadEndpoints(const std::string& file);
+    // Routes msgType requests for dstEid to responder instead of the tables.
+    // A responder already routed for msgType is kept, see chainResponder.
+    void addResponder(mctp_eid_t dstEid, uint8_t msgType,
+                      std::shared_ptr<Responder> responder);
+    // Adds responder behind the responders already added for msgType. A
+    // request goes to the first of them, in order added, that handles it.
+    void chainResponder(mctp_eid_t dstEid, uint8_t msgType,
+                        std::shared_ptr<Responder> responder);
+    // Routes VDPCI or VDIANA requests of one vendor for dstEid to responder,
+    // after any responder of the whole message type
+    void addVendorResponder(mctp_eid_t dstEid, VendorRegistry::Space space,
+                            uint32_t vendorId,
+                            std::shared_ptr<Responder> responder);
+    void setAnalyzerLimits(std::chrono::milliseconds requestTimeout,
+                           size_t maxOutstanding);
+    // Endpoints changed after sinceGeneration that are on one of networkIds
+    // (any when empty) and support all types in msgTypeMask, the EIDs removed
+    // or no longer matching since then, and the current generation
+    std::tuple<uint64_t, std::vector<EndpointRecord>, std::vector<mctp_eid_t>>
+        getEndpoints(uint64_t sinceGeneration,
+                     const std::vector<uint16_t>& networkIds,
+                     uint32_t msgTypeMask) const;
     ~MctpBinding();
 
+  protected:
+    // Physical link of the binding, null when the link is not modelled
+    std::shared_ptr<const LinkTimingModel> linkModel;
+
   private:
     uint8_t eid;
     std::shared_ptr<sdbusplus::asio::object_server> objectServer;
+    std::unique_ptr<RequestEngine> requestEngine;
+    std::unique_ptr<ComputePool> computePool;
+    std::unique_ptr<RequesterAnalyzer> requesterAnalyzer;
+    // Wire time below a millisecond not charged yet, see linkDelay
+    mutable std::chrono::microseconds linkCarry{0};
+    // Writer side copy of endpointRegistry, published after each change
+    EndpointInterfaceMap endpointInterfaces;
     EndpointInterfaceMap msgInterfaces;
     EndpointInterfaceMap vendorInterfaces;
     EndpointInterfaceMap uuidInterfaces;
+    std::unordered_map<
+        mctp_eid_t,
+        std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>>>
+        additionalInterfaces;
+    std::unordered_map<mctp_eid_t, EndpointConfig> endpointConfigs;
+    std::unordered_map<mctp_eid_t,
+                       std::unordered_map<uint8_t, std::shared_ptr<Responder>>>
+        endpointResponders;
+    std::unordered_map<mctp_eid_t, std::shared_ptr<EthernetBridge>>
+        ethernetBridges;
+    std::unordered_map<mctp_eid_t, std::shared_ptr<BusyModel>> busyModels;
+    std::unordered_map<mctp_eid_t, std::shared_ptr<Responder>>
+        anyTypeResponders;
+    std::unordered_map<mctp_eid_t, std::shared_ptr<PowerModel>> powerModels;
+    EndpointInterfaceMap powerInterfaces;
+    // Topology generation, bumped on every endpoint add, update and removal.
+    // Live endpoints carry the generation of their last change, removed ones
+    // leave a tombstone with the generation they were removed in.
+    uint64_t topologyGeneration = 0;
+    std::unordered_map<mctp_eid_t, uint64_t> endpointGenerations;
+    std::unordered_map<mctp_eid_t, uint64_t> removedEndpoints;
     void getSystemAppUuid(void);
     bool removeInterface(mctp_eid_t dstEid, EndpointInterfaceMap& interfaces);
+    void createEndpoint(const EndpointConfig& config);
+    // Responders and device models of an endpoint
+    void addEndpointModels(const EndpointConfig& config);
+    void removeEndpointModels(mctp_eid_t dstEid);
+    void addLuaResponders(const EndpointConfig& config);
+    void addDevices(const EndpointConfig& config);
+    void addCxlDevice(const EndpointConfig& config);
+    void addNcsiDevice(const EndpointConfig& config);
+    void addEthernetBridge(const EndpointConfig& config);
+    void addBusyModel(const EndpointConfig& config);
+    void addPowerModel(const EndpointConfig& config);
+    void addPlantModel(const EndpointConfig& config);
+    void addTimeSeries(const EndpointConfig& config);
+    void addBiosTables(const EndpointConfig& config);
+    void addNvmeDevice(const EndpointConfig& config);
+    void addTransportKind(const EndpointConfig& config);
+    // Wake penalty in milliseconds of a request arriving now
+    int wakeEndpoint(mctp_eid_t dstEid);
+    void removeEndpoint(mctp_eid_t dstEid);
+    void updateEndpoint(const EndpointConfig& config);
+    void publishEndpoints();
+    int linkDelay(size_t bytes, bool endpointInitiated) const;
 };
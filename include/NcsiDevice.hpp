@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Generated NC-SI over MCTP (DSP0261) network controller. Answers Get Version
+// ID, Get Capabilities, Get Link Status and the controller, NC-SI and
+// pass-through statistics commands for every package and channel. OEM
+// commands are unsupported, the response carries the manufacturer ID of the
+// request.
+//
+// Traffic counters follow from configured packet rates scaled by the load of
+// the channel and the time since the device came up, so they keep advancing
+// between polls while a poll costs the same no matter how long the device
+// has run. The NC-SI statistics count the control packets each channel
+// actually received.
+class NcsiDeviceResponder : public Responder
+{
+  public:
+    struct Params
+    {
+        uint8_t packages = 1;
+        uint8_t channels = 2;
+        // DSP0261 speed and duplex code, 0x8 is 10GBASE-T
+        uint8_t speedDuplex = 0x8;
+        std::string firmwareName = "mctp-emulator";
+        uint32_t firmwareVersion = 0x01000000;
+        uint16_t pciVendorId = 0x8086;
+        uint16_t pciDeviceId = 0x1563;
+        uint32_t manufacturerId = 343;
+        // Simulated traffic per channel
+        uint32_t rxPacketsPerSec = 10000;
+        uint32_t txPacketsPerSec = 8000;
+        uint32_t averagePacketSize = 512;
+        uint32_t passThroughPacketsPerSec = 100;
+        // Receive errors per million packets
+        uint32_t errorsPerMillion = 2;
+        // Share of the rates above carried by each channel, in package then
+        // channel order. Channels beyond the list carry 1, 7/8, 3/4 and 5/8
+        // of them in turn, so that ports tell apart.
+        std::vector<double> channelLoad;
+        int processingDelay = 1;
+    };
+
+    explicit NcsiDeviceResponder(const Params& deviceParams);
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    struct ChannelStats
+    {
+        double load = 1;
+        uint32_t packetsReceived = 0;
+        uint32_t commandsReceived = 0;
+        uint32_t commandTypeErrors = 0;
+        uint32_t checksumErrors = 0;
+        uint32_t packetsTransmitted = 0;
+    };
+
+    Params params;
+    std::chrono::steady_clock::time_point start;
+    std::vector<ChannelStats> channelStats;
+
+    // Seconds of simulated traffic so far
+    double uptime() const;
+    void controllerStatistics(const ChannelStats& stats,
+                              std::vector<uint8_t>& out) const;
+    void passThroughStatistics(const ChannelStats& stats,
+                               std::vector<uint8_t>& out) const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Generated NVMe drive answering NVMe Admin commands tunneled through NVMe-MI
+// (NVMe-MI 1.2, NVMe Admin Command message type): Identify Controller and
+// Namespace, Get Log Page for the Error Information, SMART / Health
+// Information and Telemetry logs, and Get Features. The message integrity
+// check is verified and added when the requester uses it.
+//
+// Identify data is encoded once. Log pages are written straight into the
+// response at the requested offset: the SMART counters follow from the
+// configured rates and the time the drive has been up, and error log entries
+// and telemetry blocks are a pure function of their position, so telemetry
+// logs of any size cost no memory. Other NVMe-MI messages fall through to the
+// req_resp table.
+class NvmeDeviceResponder : public Responder
+{
+  public:
+    struct Params
+    {
+        uint16_t pciVendorId = 0x8086;
+        std::string serialNumber = "MCTPEMU0000";
+        std::string modelNumber = "mctp-emulator NVMe";
+        std::string firmwareRevision = "1.0";
+        // Namespace 1, in logical blocks
+        uint64_t namespaceBlocks = 0x1D1C0BEB0;
+        // log2 of the logical block size
+        uint8_t blockSizeShift = 12;
+        // Kelvin
+        uint16_t temperature = 310;
+        uint8_t percentageUsed = 3;
+        uint64_t powerOnHours = 1200;
+        uint64_t powerCycles = 40;
+        // Host traffic per second of uptime
+        uint32_t readCommandsPerSec = 2000;
+        uint32_t writeCommandsPerSec = 1000;
+        uint32_t errorLogEntries = 64;
+        // Telemetry data area size in 512 byte blocks, per log
+        uint16_t telemetryBlocks = 2048;
+        int processingDelay = 1;
+    };
+
+    explicit NvmeDeviceResponder(const Params& deviceParams);
+
+    bool handles(const std::vector<uint8_t>& request) const override;
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    Params params;
+    std::chrono::steady_clock::time_point start;
+    std::array<uint8_t, 4096> identifyController{};
+    std::array<uint8_t, 4096> identifyNamespace{};
+    uint8_t hostTelemetryGeneration = 0;
+
+    // Writes bytes [offset, offset + size) of a log page to out, zeros past
+    // its end. False when the offset is past the end.
+    bool readLog(uint8_t logId, uint64_t offset, uint8_t* out,
+                 size_t size) const;
+    void smartLog(uint8_t* log) const;
+    uint64_t logSize(uint8_t logId) const;
+    // NVMe status field, and DW0 of the completion
+    uint16_t getFeatures(uint8_t featureId, uint8_t select,
+                         uint32_t& result) const;
+};
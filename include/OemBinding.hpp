@@ -9,7 +9,8 @@ class OemBinding : public MctpBinding
   public:
     OemBinding() = delete;
     OemBinding(std::shared_ptr<sdbusplus::asio::object_server>& objServer,
-               std::string& objPath, bindType bind);
+               std::string& objPath, bindType bind, unsigned workerThreads,
+               unsigned computeThreads, const nlohmann::json& linkConfig);
     ~OemBinding() = default;
 
   private:
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Physical plant behind the PLDM effecters and sensors of an endpoint, e.g.
+// a fan duty cycle driving a temperature. Every sensor follows a first-order
+// lag towards its ambient value plus the weighted sum of its input effecters,
+// integrated on a fixed step timer on the io_context. Effecter writes and
+// sensor reads come from the endpoint strand, hence the lock.
+class PlantModel : public std::enable_shared_from_this<PlantModel>
+{
+  public:
+    struct NumericEffecter
+    {
+        uint16_t id = 0;
+        double value = 0;
+        double min = 0;
+        double max = 100;
+        // Engineering units per raw PLDM count
+        double resolution = 1;
+    };
+
+    struct StateEffecter
+    {
+        uint16_t id = 0;
+        // Present state of every composite effecter
+        std::vector<uint8_t> states;
+    };
+
+    struct Input
+    {
+        uint16_t effecterId = 0;
+        // Contribution to the sensor target per unit of effecter value. State
+        // effecters contribute the state of their first composite effecter.
+        double gain = 0;
+    };
+
+    struct Sensor
+    {
+        uint16_t id = 0;
+        double value = 0;
+        double ambient = 0;
+        std::chrono::milliseconds timeConstant{1000};
+        double resolution = 1;
+        std::vector<Input> inputs;
+    };
+
+    struct Params
+    {
+        std::chrono::milliseconds step{10};
+        std::vector<NumericEffecter> numericEffecters;
+        std::vector<StateEffecter> stateEffecters;
+        std::vector<Sensor> sensors;
+    };
+
+    PlantModel(boost::asio::io_context& ioc, const Params& plantParams);
+    PlantModel(const PlantModel&) = delete;
+    PlantModel& operator=(const PlantModel&) = delete;
+    ~PlantModel();
+
+    // Arms the step timer. Its handler locks weak_from_this(), which is empty
+    // until make_shared has returned. Does nothing without a step or sensors.
+    void start();
+
+    // The set of effecters and sensors never changes, these need no lock
+    const NumericEffecter* numericEffecter(uint16_t id) const;
+    bool hasStateEffecter(uint16_t id) const;
+    const Sensor* sensor(uint16_t id) const;
+
+    std::optional<double> sensorValue(uint16_t id);
+    std::optional<double> numericValue(uint16_t id);
+    // False when the value is out of range
+    bool setNumericValue(uint16_t id, double value);
+    std::optional<std::vector<uint8_t>> states(uint16_t id);
+    // nullopt leaves that composite effecter unchanged. False when the count
+    // of states does not match the effecter.
+    bool setStates(uint16_t id,
+                   const std::vector<std::optional<uint8_t>>& requested);
+
+  private:
+    Params params;
+    std::unordered_map<uint16_t, size_t> numericIndex;
+    std::unordered_map<uint16_t, size_t> stateIndex;
+    std::unordered_map<uint16_t, size_t> sensorIndex;
+    // Share of the distance to the target covered per step, by sensor
+    std::vector<double> smoothing;
+    std::mutex lock;
+    boost::asio::steady_timer stepTimer;
+
+    double inputValue(uint16_t effecterId) const;
+    void integrate();
+    void scheduleStep();
+};
+
+// Answers the PLDM Platform Monitoring and Control commands of a plant:
+// GetSensorReading, Set/GetNumericEffecterValue and Set/GetStateEffecterStates.
+// Requests for sensors and effecters the plant does not model, and all other
+// commands, fall through to the req_resp table.
+class PldmPlantResponder : public Responder
+{
+  public:
+    PldmPlantResponder(std::shared_ptr<PlantModel> plantModel,
+                       int processingDelay);
+
+    bool handles(const std::vector<uint8_t>& request) const override;
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    std::shared_ptr<PlantModel> plant;
+    int delay;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Index of PLDM req_resp entries keyed on decoded request fields instead of
+// raw bytes, so one entry can answer every sensor or a single record handle
+// without spelling out whole requests. The first level is the PLDM type and
+// command, the second a flat map on the values of the command's key fields:
+//
+//   sensor-id       GetSensorReading, GetStateSensorReadings and the other
+//                   sensor commands
+//   effecter-id     Numeric and state effecter commands
+//   record-handle,  GetPDR
+//   transfer-flag
+//   transfer-flag,  GetBIOSTable
+//   table-type
+//
+// A field an entry leaves out matches any value, and a list of values
+// matches each of them. When several entries match, the one giving the most
+// fields wins.
+class PldmKeyIndex
+{
+  public:
+    // Adds the entry with "pldm-type", "command" and optional key fields.
+    // False when it gives a field the command doesn't have, throws
+    // json::exception for a malformed key.
+    bool add(const nlohmann::json& key, size_t id);
+
+    // Entry answering request, which starts at the header version / PLDM
+    // type byte
+    std::optional<size_t> find(const uint8_t* request, size_t size) const;
+
+    bool empty() const
+    {
+        return commands.empty();
+    }
+
+  private:
+    // Little endian request field, offset counted from the byte after the
+    // command
+    struct Field
+    {
+        const char* name;
+        size_t offset;
+        size_t width;
+    };
+
+    // Entries giving the same set of fields, bit n for field n of the
+    // command
+    struct Level
+    {
+        unsigned fields;
+        std::unordered_map<uint64_t, size_t> entries;
+    };
+
+    struct Command
+    {
+        const std::vector<Field>* fields;
+        // Most specific first
+        std::vector<Level> levels;
+    };
+
+    // By PLDM type << 8 | command
+    std::unordered_map<uint16_t, Command> commands;
+
+    static const std::vector<Field>& commandFields(uint16_t command);
+};
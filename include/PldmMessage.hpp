@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// PLDM messages as the responders see them, MCTP message type byte first.
+// Header: message type, Rq/D/instance ID, header version/PLDM type, command
+constexpr size_t pldmHeaderSize = 4;
+constexpr uint8_t pldmRequestBit = 0x80;
+constexpr uint8_t pldmInstanceIdMask = 0x1F;
+constexpr uint8_t pldmTypeMask = 0x3F;
+
+constexpr uint8_t pldmTypePlatform = 0x02;
+constexpr uint8_t pldmTypeBios = 0x03;
+
+// Generic completion codes (DSP0240)
+constexpr uint8_t pldmSuccess = 0x00;
+constexpr uint8_t pldmErrorInvalidData = 0x02;
+constexpr uint8_t pldmErrorInvalidLength = 0x03;
+
+constexpr uint8_t pldmGetSensorReading = 0x11;
+
+// Numeric data sizes, uint8 through sint32
+constexpr uint8_t pldmDataSizeSint32 = 0x05;
+
+// True for a full header of a request of pldmType
+bool isPldmRequest(const std::vector<uint8_t>& request, uint8_t pldmType);
+
+// Header of the response to request, followed by a success completion code
+std::vector<uint8_t> pldmResponseHeader(const std::vector<uint8_t>& request);
+
+// Appends raw, rounded and saturated to the range of the numeric dataSize.
+// NaN is sent as 0.
+void appendPldmValue(std::vector<uint8_t>& out, uint8_t dataSize, double raw);
+
+// Appends the GetSensorReading response fields after the completion code for
+// an enabled sensor in the normal state, without event generation
+void appendSensorReading(std::vector<uint8_t>& out, uint8_t dataSize,
+                         double raw);
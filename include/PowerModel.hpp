@@ -0,0 +1,67 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Power state of an emulated endpoint. The endpoint drops from active to idle
+// after idleTimeout without requests, and from idle to low power after a
+// further lowPowerTimeout. The first request after that pays the wake penalty
+// of the state it found the endpoint in, requests arriving while it wakes up
+// wait for the rest of it. A timeout of zero disables the state. Used from
+// the io_context thread only.
+class PowerModel : public std::enable_shared_from_this<PowerModel>
+{
+  public:
+    enum class State
+    {
+        active,
+        idle,
+        lowPower
+    };
+
+    struct Params
+    {
+        std::chrono::milliseconds idleTimeout{1000};
+        std::chrono::milliseconds lowPowerTimeout{0};
+        std::chrono::milliseconds idleWakePenalty{0};
+        std::chrono::milliseconds lowPowerWakePenalty{0};
+    };
+
+    using StateHandler = std::function<void(State)>;
+
+    PowerModel(boost::asio::io_context& ioc, const Params& powerParams,
+               StateHandler onStateChange);
+    PowerModel(const PowerModel&) = delete;
+    PowerModel& operator=(const PowerModel&) = delete;
+    ~PowerModel();
+
+    // Starts the countdown to idle or low power for an endpoint that has just
+    // come up active. Call once the model is owned by a shared_ptr.
+    void start();
+
+    // Wakes the endpoint for a request and returns the wake penalty
+    std::chrono::milliseconds requestArrived();
+
+    State state() const
+    {
+        return current;
+    }
+    static std::string toString(State state);
+
+  private:
+    Params params;
+    StateHandler onChange;
+    State current = State::active;
+    // End of the wake up in progress, if any
+    std::chrono::steady_clock::time_point wakingUntil;
+    boost::asio::steady_timer stateTimer;
+    uint64_t timerGeneration = 0;
+
+    void enter(State state);
+    void scheduleDrop();
+};
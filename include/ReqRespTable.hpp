@@ -0,0 +1,78 @@
+#pragma once
+
+#include "PldmKeys.hpp"
+#include "RequestMatcher.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One request/response array of a req_resp file. Requests are matched
+// without the header bytes the caller takes from the payload, a null request
+// byte matches any value. PLDM tables may also key entries on decoded fields
+// (see PldmKeyIndex), those are looked up before the raw requests. Entries
+// whose request, key, response or delay can't be read are left out.
+class CompiledTable
+{
+  public:
+    struct Entry
+    {
+        int processingDelay;
+        std::vector<uint8_t> response;
+    };
+
+    explicit CompiledTable(const nlohmann::json& table, bool pldm = false);
+
+    // The first entry whose request matches, null when none does
+    const Entry* find(const uint8_t* data, size_t size) const;
+
+  private:
+    RequestMatcher matcher;
+    // Entry of each pattern in matcher
+    std::vector<size_t> patternEntries;
+    PldmKeyIndex keys;
+    std::vector<Entry> entries;
+};
+
+// A parsed req_resp file with every table in it compiled. Tables are found
+// by their path of keys: the message type, then the vendor name and table
+// key for vendor defined messages.
+class ReqRespFile
+{
+  public:
+    explicit ReqRespFile(const nlohmann::json& document);
+
+    // Null when there is no table at path
+    const CompiledTable* table(const std::vector<std::string>& path) const;
+
+  private:
+    std::map<std::vector<std::string>, CompiledTable> tables;
+
+    void compile(const nlohmann::json& node, std::vector<std::string>& path);
+};
+
+// Parsed req_resp files by name, shared by the request handlers. A file is
+// parsed and compiled once and again only after its modification time
+// changes, instead of on every request.
+class ReqRespCache
+{
+  public:
+    // Null when the file can't be read or parsed
+    std::shared_ptr<const ReqRespFile> get(const std::string& fileName);
+
+  private:
+    struct Cached
+    {
+        std::filesystem::file_time_type modified;
+        std::shared_ptr<const ReqRespFile> file;
+    };
+
+    std::shared_mutex lock;
+    std::unordered_map<std::string, Cached> files;
+};
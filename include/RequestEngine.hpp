@@ -0,0 +1,67 @@
+#pragma once
+
+#include <libmctp.h>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Runs request processing off the D-Bus thread.
+//
+// Every EID owns a strand on a shared thread pool: requests to the same
+// endpoint are processed strictly in arrival order, one at a time, the way a
+// single threaded device would, while different endpoints proceed in
+// parallel. Completions are delivered back on the io_context the D-Bus
+// connection lives on, in the order the strand produced them.
+class RequestEngine
+{
+  public:
+    RequestEngine(boost::asio::io_context& ioc, unsigned threads);
+    RequestEngine() = delete;
+    RequestEngine(const RequestEngine&) = delete;
+    RequestEngine& operator=(const RequestEngine&) = delete;
+    ~RequestEngine();
+
+    // Runs work() on the strand of dstEid and completes token with its
+    // result, e.g. a yield_context to suspend the calling D-Bus handler.
+    template <typename Work, typename CompletionToken>
+    auto process(mctp_eid_t dstEid, Work&& work, CompletionToken&& token)
+    {
+        using Result = std::invoke_result_t<Work>;
+        return boost::asio::async_initiate<CompletionToken, void(Result)>(
+            [this, dstEid](auto handler, auto&& job) {
+                auto resultExecutor = boost::asio::get_associated_executor(
+                    handler, ioContext.get_executor());
+                auto guard = boost::asio::make_work_guard(resultExecutor);
+                boost::asio::post(
+                    strands[dstEid],
+                    [job = std::forward<decltype(job)>(job),
+                     handler = std::move(handler),
+                     guard = std::move(guard)]() mutable {
+                        Result result = job();
+                        auto ex = guard.get_executor();
+                        boost::asio::post(
+                            ex, [handler = std::move(handler),
+                                 result = std::move(result)]() mutable {
+                                handler(std::move(result));
+                            });
+                        guard.reset();
+                    });
+            },
+            token, std::forward<Work>(work));
+    }
+
+  private:
+    using Strand = boost::asio::strand<boost::asio::thread_pool::executor_type>;
+
+    boost::asio::io_context& ioContext;
+    boost::asio::thread_pool pool;
+    // Indexed by EID
+    std::vector<Strand> strands;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Finds the first of a list of request patterns that matches a payload. A
+// pattern matches a payload of the same length whose bytes equal the
+// pattern's wherever its mask byte is set; mask bits that are clear are
+// wildcards.
+//
+// Patterns of up to 32 bytes are stored transposed in blocks of 32: row i of
+// a block holds byte i of every pattern in it. One pass over the rows of a
+// block compares the payload with all its patterns at once, with AVX2 or
+// NEON where available and eight patterns per 64 bit word otherwise. Most
+// tables fit a block per length, so a lookup costs a row per payload byte
+// no matter where the hit is or how many wildcards there are. Longer
+// patterns are compared one by one.
+class RequestMatcher
+{
+  public:
+    static constexpr size_t maxBlockLength = 32;
+    static constexpr size_t lanes = 32;
+
+    // Adds the next pattern, mask has the size of bytes
+    void add(const std::vector<uint8_t>& bytes,
+             const std::vector<uint8_t>& mask);
+
+    // Index of the first pattern added that matches
+    std::optional<size_t> match(const uint8_t* data, size_t size) const;
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // Name of the block compare in use, "avx2", "neon" or "scalar"
+    static const char* implementation();
+
+  private:
+    struct alignas(32) Row
+    {
+        std::array<uint8_t, lanes> value{};
+        std::array<uint8_t, lanes> mask{};
+    };
+
+    struct Block
+    {
+        // 0xFF for the lanes holding a pattern
+        alignas(32) std::array<uint8_t, lanes> initial{};
+        std::vector<Row> rows;
+        std::array<size_t, lanes> ids{};
+        // Lanes holding a pattern
+        uint32_t used = 0;
+    };
+
+    struct Pattern
+    {
+        size_t id;
+        std::vector<uint8_t> value;
+        std::vector<uint8_t> mask;
+    };
+
+    size_t count = 0;
+    // Indexed by pattern length
+    std::array<std::vector<Block>, maxBlockLength + 1> blocks;
+    std::unordered_map<size_t, std::vector<Pattern>> longPatterns;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <libmctp.h>
+
+#include <array>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Watches requester behavior that inflates MCTP load: PLDM instance IDs
+// reused while still outstanding, identical requests resent before the
+// previous one could have timed out, and more concurrent requests to one
+// endpoint than it can take. Findings are counted per D-Bus client and
+// summarized to the journal periodically.
+//
+// Only used from the D-Bus thread. State is bounded: a fixed ring of recent
+// requests per endpoint and a capped number of clients.
+class RequesterAnalyzer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct RequestHandle
+    {
+        mctp_eid_t eid;
+        size_t slot;
+        uint64_t seq;
+    };
+
+    // sender, requests, instance ID reuses, early retries, over-subscribed
+    using ClientStats =
+        std::tuple<std::string, uint64_t, uint64_t, uint64_t, uint64_t>;
+
+    explicit RequesterAnalyzer(boost::asio::io_context& ioc);
+    RequesterAnalyzer() = delete;
+
+    // timeout is how long the requester waits for this request. Requests
+    // sent without one use the configured default.
+    RequestHandle requestStarted(const std::string& sender, mctp_eid_t eid,
+                                 const std::vector<uint8_t>& payload,
+                                 std::chrono::milliseconds timeout);
+    RequestHandle requestStarted(const std::string& sender, mctp_eid_t eid,
+                                 const std::vector<uint8_t>& payload);
+    // The request stops being outstanding once its response is sent
+    void responseScheduled(const RequestHandle& handle,
+                           std::chrono::milliseconds after);
+
+    void setLimits(std::chrono::milliseconds requestTimeout,
+                   size_t maxOutstanding);
+    std::vector<ClientStats> getStats() const;
+    void resetStats();
+
+  private:
+    static constexpr size_t historyPerEndpoint = 32;
+    static constexpr size_t maxClients = 1024;
+    static constexpr std::chrono::seconds summaryInterval{60};
+
+    struct Request
+    {
+        uint64_t seq = 0;
+        size_t senderHash = 0;
+        size_t payloadHash = 0;
+        // PLDM instance ID, or -1 for other message types
+        int instanceId = -1;
+        Clock::time_point outstandingUntil;
+    };
+
+    struct Counters
+    {
+        uint64_t requests = 0;
+        uint64_t instanceIdReuse = 0;
+        uint64_t earlyRetries = 0;
+        uint64_t overSubscribed = 0;
+    };
+
+    struct Client
+    {
+        Counters total;
+        Counters reported;
+        Clock::time_point lastSeen;
+    };
+
+    std::chrono::milliseconds defaultTimeout{100};
+    size_t outstandingLimit = 8;
+    uint64_t nextSeq = 1;
+    std::unordered_map<mctp_eid_t, std::array<Request, historyPerEndpoint>>
+        history;
+    std::unordered_map<std::string, Client> clients;
+    boost::asio::steady_timer summaryTimer;
+
+    Client& client(const std::string& sender, Clock::time_point now);
+    void scheduleSummary();
+    void logSummary();
+};
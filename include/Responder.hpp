@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct MctpResponse
+{
+    // Milliseconds until the response is sent, negative for no response
+    int processingDelay = 0;
+    std::vector<uint8_t> payload;
+    // CPU heavy responses leave payload empty and set this instead. It is run
+    // on the compute pool and the response goes out once both the result and
+    // the processing delay are in. nullopt means no response.
+    std::function<std::optional<std::vector<uint8_t>>()> compute;
+};
+
+// Produces responses in code for one endpoint and MCTP message type, in place
+// of the req_resp table lookup.
+class Responder
+{
+  public:
+    virtual ~Responder() = default;
+
+    // Requests a responder does not handle fall through to the req_resp table
+    virtual bool handles(const std::vector<uint8_t>&) const
+    {
+        return true;
+    }
+
+    // Runs on the strand of the endpoint, so calls for one endpoint are
+    // serialized and in request order. Anything expensive that does not
+    // depend on responder state belongs in MctpResponse::compute.
+    virtual std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) = 0;
+};
+
+// Offers each request to several responders of one endpoint and message type
+// in turn, e.g. the plant model and the BIOS tables of a PLDM endpoint. The
+// first one that handles the request answers it.
+class ResponderChain : public Responder
+{
+  public:
+    void add(std::shared_ptr<Responder> responder)
+    {
+        responders.push_back(std::move(responder));
+    }
+
+    bool handles(const std::vector<uint8_t>& request) const override
+    {
+        return std::any_of(responders.begin(), responders.end(),
+                           [&request](const auto& responder) {
+                               return responder->handles(request);
+                           });
+    }
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override
+    {
+        for (const auto& responder : responders)
+        {
+            if (responder->handles(request))
+            {
+                return responder->respond(request);
+            }
+        }
+        return std::nullopt;
+    }
+
+  private:
+    std::vector<std::shared_ptr<Responder>> responders;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Recorded time series mapped read-only from a columnar file, as written by
+// scripts/csv2timeseries.py. All fields are little endian:
+//
+//   "MTSR", uint32 version (1), uint32 column count, uint32 reserved,
+//   uint64 row count
+//   column names, 32 bytes each, NUL padded
+//   timestamps, int64 microseconds, ascending
+//   one float64 array per column
+//
+// Nothing is copied out of the file. Values are interpolated between the two
+// samples around the requested time, found by a binary search over the
+// timestamps.
+class TimeSeries
+{
+  public:
+    enum class End
+    {
+        // Start over from the first sample
+        loop,
+        // Hold the last sample
+        clamp
+    };
+
+    // Throws std::runtime_error when the file can't be mapped or is not a
+    // valid time series
+    explicit TimeSeries(const std::string& fileName);
+    TimeSeries(const TimeSeries&) = delete;
+    TimeSeries& operator=(const TimeSeries&) = delete;
+    ~TimeSeries();
+
+    // nullopt when there is no column by that name
+    std::optional<size_t> column(const std::string& name) const;
+
+    // Value of column at time since the first sample
+    double value(size_t column, std::chrono::microseconds time,
+                 End end) const;
+
+  private:
+    static constexpr size_t headerSize = 24;
+    static constexpr size_t nameSize = 32;
+
+    const uint8_t* map = nullptr;
+    size_t mapSize = 0;
+    uint64_t rows = 0;
+    const uint8_t* timestamps = nullptr;
+    std::vector<const uint8_t*> columns;
+    std::unordered_map<std::string, size_t> columnIndex;
+
+    int64_t timestamp(uint64_t row) const;
+};
+
+// Answers PLDM GetSensorReading for numeric sensors played back from a
+// recorded time series, so real traces rather than fixed bytes reach the
+// requester. Playback starts when the endpoint is created and runs at speed
+// times real time. Readings are (value - offset) / resolution, saturated to
+// the sensor data size; unsigned 32 bit sensors make telemetry counters.
+// Other sensors and commands fall through to the req_resp table.
+class PldmTimeSeriesResponder : public Responder
+{
+  public:
+    struct Sensor
+    {
+        uint16_t id = 0;
+        size_t column = 0;
+        double resolution = 1;
+        double offset = 0;
+        // PLDM sensor data size, uint8 (0) to sint32 (5)
+        uint8_t dataSize = 5;
+    };
+
+    struct Params
+    {
+        TimeSeries::End end = TimeSeries::End::loop;
+        double speed = 1;
+        std::vector<Sensor> sensors;
+        int processingDelay = 1;
+    };
+
+    PldmTimeSeriesResponder(std::shared_ptr<const TimeSeries> timeSeries,
+                            const Params& responderParams);
+
+    bool handles(const std::vector<uint8_t>& request) const override;
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    std::shared_ptr<const TimeSeries> series;
+    Params params;
+    std::unordered_map<uint16_t, size_t> sensorIndex;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Endpoint kinds for benchmarking the transport itself. They answer every
+// message type without looking at tables or protocols, so that sweeping the
+// message size measures D-Bus, the link model and response scheduling only.
+
+// Returns the request unchanged
+class EchoResponder : public Responder
+{
+  public:
+    explicit EchoResponder(int processingDelay) : delay(processingDelay)
+    {}
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    int delay;
+};
+
+// Returns as many bytes as the little endian uint32 after the message type
+// asks for, the message type included. Requests too short to carry the size
+// get a response of their own size.
+class SizedResponder : public Responder
+{
+  public:
+    // Larger sizes are clamped to this
+    static constexpr uint32_t maxResponseSize = 1024 * 1024;
+
+    explicit SizedResponder(int processingDelay) : delay(processingDelay)
+    {}
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    int delay;
+};
+
+// Answers like SizedResponder with self-checking payloads, see
+// IntegrityPayload. Sizes below the minimum payload are raised to it.
+class IntegrityResponder : public Responder
+{
+  public:
+    explicit IntegrityResponder(int processingDelay) : delay(processingDelay)
+    {}
+
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    int delay;
+    // Requests to an endpoint are answered one at a time on its strand
+    uint32_t sequence = 0;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Responder.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Vendors of vendor defined messages, by PCI vendor ID (VDPCI, 0x7E) or IANA
+// enterprise number (VDIANA, 0x7F).
+//
+// Each vendor brings a parser for its part of the message header. The parser
+// tells how many bytes form the header and, optionally, a sub table key such
+// as the Intel vendor type code. Table requests of the vendor are found under
+// <VDPCI|VDIANA>/<vendor name>[/<sub table key>] in the req_resp files.
+//
+// Vendors are stored in an open addressed table, so looking one up is a
+// single hash and usually a single probe. The registry is filled before
+// requests are served and only read afterwards.
+class VendorRegistry
+{
+  public:
+    enum class Space : uint8_t
+    {
+        pci,
+        iana
+    };
+
+    struct Header
+    {
+        // Bytes from the message type up to the vendor payload
+        size_t size;
+        // Empty when the vendor's table has no sub tables
+        std::string tableKey;
+    };
+
+    // nullopt rejects the message
+    using Parser =
+        std::function<std::optional<Header>(const std::vector<uint8_t>&)>;
+
+    struct Vendor
+    {
+        Space space;
+        uint32_t id;
+        std::string name;
+        Parser parser;
+    };
+
+    VendorRegistry();
+
+    // Without a parser only the message type and vendor ID form the header
+    void add(Space space, uint32_t id, std::string name,
+             Parser parser = nullptr);
+    const Vendor* find(Space space, uint32_t id) const;
+
+    // Vendor space and ID of a VDPCI or VDIANA payload
+    static std::optional<std::pair<Space, uint32_t>>
+        vendorOf(const std::vector<uint8_t>& payload);
+
+    // Vendor of a VDPCI or VDIANA payload, nullptr if unknown
+    const Vendor* identify(const std::vector<uint8_t>& payload) const;
+
+  private:
+    // Power of two sized, free slots have an empty name
+    std::vector<Vendor> slots;
+    size_t used = 0;
+
+    size_t slotOf(Space space, uint32_t id) const;
+    void grow();
+};
+
+extern VendorRegistry vendorRegistry;
+
+// Routes the VDPCI or VDIANA messages of one endpoint to per-vendor
+// responders. Vendors without a responder fall through to the tables.
+class VendorResponder : public Responder
+{
+  public:
+    void add(uint32_t id, std::shared_ptr<Responder> responder);
+
+    bool handles(const std::vector<uint8_t>& request) const override;
+    std::optional<MctpResponse>
+        respond(const std::vector<uint8_t>& request) override;
+
+  private:
+    // Endpoints talk to a handful of vendors at most, a scan is fastest
+    std::vector<std::pair<uint32_t, std::shared_ptr<Responder>>> vendors;
+
+    Responder* find(const std::vector<uint8_t>& request) const;
+};
@@ -0,0 +1,48 @@
+#!/usr/bin/python3
+# converts a CSV trace into the columnar time series file the emulator plays
+# back. The first column is the timestamp, every other column one series,
+# named after its header. Rows are sorted by timestamp.
+
+import argparse
+import csv
+import struct
+
+NAME_SIZE = 32
+UNITS = {'s': 1000000, 'ms': 1000, 'us': 1}
+
+parser = argparse.ArgumentParser(
+    description='Convert a CSV trace to an mctp-emulator time series')
+parser.add_argument('csv', help='input file, header row first')
+parser.add_argument('output', help='time series file to write')
+parser.add_argument('--time-unit', choices=UNITS.keys(), default='s',
+                    help='unit of the timestamp column (default: s)')
+args = parser.parse_args()
+
+with open(args.csv, newline='') as f:
+    reader = csv.reader(f)
+    header = next(reader)
+    rows = [row for row in reader if row]
+
+names = header[1:]
+for name in names:
+    if len(name.encode()) > NAME_SIZE:
+        parser.error('column name {} is longer than {} bytes'.format(
+            name, NAME_SIZE))
+if not rows:
+    parser.error('{} has no samples'.format(args.csv))
+
+scale = UNITS[args.time_unit]
+samples = sorted((round(float(row[0]) * scale), row[1:]) for row in rows)
+
+with open(args.output, 'wb') as f:
+    f.write(struct.pack('<4sIIIQ', b'MTSR', 1, len(names), 0, len(samples)))
+    for name in names:
+        f.write(struct.pack('<32s', name.encode()))
+    f.write(struct.pack('<{}q'.format(len(samples)),
+                        *(time for time, _ in samples)))
+    for i in range(len(names)):
+        f.write(struct.pack('<{}d'.format(len(samples)),
+                            *(float(values[i]) for _, values in samples)))
+
+print('wrote {} samples of {} columns to {}'.format(
+    len(samples), len(names), args.output))
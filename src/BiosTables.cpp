@@ -0,0 +1,403 @@
+#include "BiosTables.hpp"
+
+#include "ByteOrder.hpp"
+#include "Crc.hpp"
+#include "PldmMessage.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+// BIOS Control and Configuration commands
+constexpr uint8_t pldmGetBiosTable = 0x01;
+constexpr uint8_t pldmSetBiosAttributeCurrentValue = 0x07;
+constexpr uint8_t pldmGetBiosAttributeCurrentValueByHandle = 0x08;
+
+// BIOS completion codes
+constexpr uint8_t pldmInvalidDataTransferHandle = 0x80;
+constexpr uint8_t pldmInvalidTransferOperationFlag = 0x81;
+constexpr uint8_t pldmInvalidTransferFlag = 0x82;
+constexpr uint8_t pldmBiosTableUnavailable = 0x83;
+constexpr uint8_t pldmInvalidBiosTableType = 0x85;
+constexpr uint8_t pldmInvalidBiosAttrHandle = 0x88;
+
+// Transfer operation flags and transfer flags
+constexpr uint8_t pldmGetNextPart = 0x00;
+constexpr uint8_t pldmGetFirstPart = 0x01;
+constexpr uint8_t pldmTransferStart = 0x01;
+constexpr uint8_t pldmTransferMiddle = 0x02;
+constexpr uint8_t pldmTransferEnd = 0x04;
+constexpr uint8_t pldmTransferStartAndEnd = 0x05;
+
+// The pending attribute value table, which has nothing pending here
+constexpr uint8_t pendingValueTable = 0x03;
+
+// Attribute and string handles are 16 bit, leave room for the value strings
+constexpr size_t maxAttributes = 0xF000;
+
+// Possible values of generated enumeration attributes
+static const std::vector<std::string> generatedValues = {"Disabled", "Enabled",
+                                                         "Auto"};
+
+// Pads a table to a multiple of four bytes and appends its CRC-32
+static void finishTable(std::vector<uint8_t>& table)
+{
+    table.resize((table.size() + 3) & ~size_t{3}, 0);
+    appendLe(table, crc32(table.data(), table.size()), 4);
+}
+
+BiosTableResponder::BiosTableResponder(const Params& biosParams) :
+    params(biosParams)
+{
+    params.attributes.resize(
+        std::min(params.attributes.size(), maxAttributes));
+    size_t generated = std::min(params.generatedAttributes,
+                                maxAttributes - params.attributes.size());
+    for (size_t i = 0; i < generated; i++)
+    {
+        Attribute attribute;
+        attribute.name = "Attribute" + std::to_string(i);
+        switch (i % 3)
+        {
+            case 0:
+                attribute.type = Attribute::Type::enumeration;
+                attribute.values = generatedValues;
+                attribute.defaultIndex = static_cast<uint8_t>(i % 2);
+                break;
+            case 1:
+                attribute.type = Attribute::Type::integer;
+                attribute.upperBound = 1000;
+                attribute.defaultValue = i % 1000;
+                break;
+            default:
+                attribute.type = Attribute::Type::string;
+                attribute.maxLength = 32;
+                attribute.defaultString = "Value" + std::to_string(i);
+                break;
+        }
+        params.attributes.push_back(std::move(attribute));
+    }
+    buildTables();
+}
+
+void BiosTableResponder::buildTables()
+{
+    std::vector<uint8_t> strings;
+    std::vector<uint8_t> attributes;
+    std::vector<uint8_t> values;
+    std::unordered_map<std::string, uint16_t> stringHandles;
+    auto stringHandle = [&](const std::string& name) {
+        auto [iter, added] = stringHandles.try_emplace(
+            name, static_cast<uint16_t>(stringHandles.size()));
+        if (added)
+        {
+            appendLe(strings, iter->second, 2);
+            appendLe(strings, name.size(), 2);
+            strings.insert(strings.end(), name.begin(), name.end());
+        }
+        return iter->second;
+    };
+
+    for (size_t handle = 0; handle < params.attributes.size(); handle++)
+    {
+        const Attribute& attribute = params.attributes[handle];
+        auto type = static_cast<uint8_t>(attribute.type);
+        appendLe(attributes, handle, 2);
+        attributes.push_back(type);
+        appendLe(attributes, stringHandle(attribute.name), 2);
+        appendLe(values, handle, 2);
+        values.push_back(type);
+
+        AttributeInfo info{attribute.type,
+                           values.size(),
+                           0,
+                           static_cast<uint8_t>(attribute.values.size()),
+                           attribute.minLength,
+                           attribute.maxLength,
+                           attribute.lowerBound,
+                           attribute.upperBound};
+        switch (attribute.type)
+        {
+            case Attribute::Type::enumeration:
+                attributes.push_back(info.possibleValues);
+                for (const std::string& value : attribute.values)
+                {
+                    appendLe(attributes, stringHandle(value), 2);
+                }
+                attributes.push_back(1);
+                attributes.push_back(attribute.defaultIndex);
+                values.push_back(1);
+                values.push_back(attribute.defaultIndex);
+                break;
+            case Attribute::Type::string:
+                // String type unknown
+                attributes.push_back(0x00);
+                appendLe(attributes, attribute.minLength, 2);
+                appendLe(attributes, attribute.maxLength, 2);
+                appendLe(attributes, attribute.defaultString.size(), 2);
+                attributes.insert(attributes.end(),
+                                  attribute.defaultString.begin(),
+                                  attribute.defaultString.end());
+                appendLe(values, attribute.defaultString.size(), 2);
+                values.insert(values.end(), attribute.defaultString.begin(),
+                              attribute.defaultString.end());
+                break;
+            case Attribute::Type::integer:
+                appendLe(attributes, attribute.lowerBound, 8);
+                appendLe(attributes, attribute.upperBound, 8);
+                appendLe(attributes, attribute.scalarIncrement, 4);
+                appendLe(attributes, attribute.defaultValue, 8);
+                appendLe(values, attribute.defaultValue, 8);
+                break;
+        }
+        info.valueSize = values.size() - info.valueOffset;
+        attributeInfo.push_back(info);
+    }
+
+    valueTableSize = values.size();
+    for (auto* table : {&strings, &attributes, &values})
+    {
+        finishTable(*table);
+    }
+    tables = {std::make_shared<std::vector<uint8_t>>(std::move(strings)),
+              std::make_shared<std::vector<uint8_t>>(std::move(attributes)),
+              std::make_shared<std::vector<uint8_t>>(std::move(values))};
+}
+
+std::vector<uint8_t>& BiosTableResponder::writableValueTable()
+{
+    // A transfer still holds this table, leave it as it is
+    if (tables[valueTable].use_count() > 1)
+    {
+        tables[valueTable] =
+            std::make_shared<std::vector<uint8_t>>(*tables[valueTable]);
+    }
+    return *tables[valueTable];
+}
+
+bool BiosTableResponder::handles(const std::vector<uint8_t>& request) const
+{
+    if (!isPldmRequest(request, pldmTypeBios))
+    {
+        return false;
+    }
+    return request[3] == pldmGetBiosTable ||
+           request[3] == pldmSetBiosAttributeCurrentValue ||
+           request[3] == pldmGetBiosAttributeCurrentValueByHandle;
+}
+
+uint8_t BiosTableResponder::getTable(const std::vector<uint8_t>& request,
+                                     std::vector<uint8_t>& out)
+{
+    if (request.size() != pldmHeaderSize + 6)
+    {
+        return pldmErrorInvalidLength;
+    }
+    size_t handle = readLe(&request[4], 4);
+    uint8_t operation = request[8];
+    uint8_t tableType = request[9];
+    if (tableType == pendingValueTable)
+    {
+        return pldmBiosTableUnavailable;
+    }
+    if (tableType >= tableCount)
+    {
+        return pldmInvalidBiosTableType;
+    }
+
+    auto& transfer = transfers[tableType];
+    if (operation == pldmGetFirstPart)
+    {
+        if (tableType == valueTable && valueChecksumStale)
+        {
+            std::vector<uint8_t>& table = writableValueTable();
+            table.resize(valueTableSize);
+            finishTable(table);
+            valueChecksumStale = false;
+        }
+        transfer = tables[tableType];
+        handle = 0;
+    }
+    else if (operation != pldmGetNextPart)
+    {
+        return pldmInvalidTransferOperationFlag;
+    }
+    else if (!transfer || handle == 0 || handle >= transfer->size())
+    {
+        return pldmInvalidDataTransferHandle;
+    }
+
+    // The transfer handle is the offset of the next part in the table
+    size_t size = std::min<size_t>(params.transferSize,
+                                   transfer->size() - handle);
+    size_t next = handle + size;
+    bool end = next == transfer->size();
+    uint8_t flag = handle == 0 ? (end ? pldmTransferStartAndEnd
+                                      : pldmTransferStart)
+                               : (end ? pldmTransferEnd : pldmTransferMiddle);
+    appendLe(out, end ? 0 : next, 4);
+    out.push_back(flag);
+    auto begin = transfer->begin() + static_cast<std::ptrdiff_t>(handle);
+    out.insert(out.end(), begin, begin + static_cast<std::ptrdiff_t>(size));
+    if (end)
+    {
+        transfer.reset();
+    }
+    return pldmSuccess;
+}
+
+uint8_t BiosTableResponder::setAttribute(const std::vector<uint8_t>& request)
+{
+    // Transfer handle and flag, then the attribute handle and type
+    constexpr size_t valueStart = pldmHeaderSize + 8;
+    if (request.size() < valueStart)
+    {
+        return pldmErrorInvalidLength;
+    }
+    // Attribute values are small, they come in a single part
+    if (request[8] != pldmTransferStartAndEnd)
+    {
+        return pldmInvalidTransferFlag;
+    }
+    size_t handle = readLe(&request[9], 2);
+    if (handle >= attributeInfo.size())
+    {
+        return pldmInvalidBiosAttrHandle;
+    }
+    AttributeInfo& info = attributeInfo[handle];
+    if (request[11] != static_cast<uint8_t>(info.type))
+    {
+        return pldmErrorInvalidData;
+    }
+
+    const uint8_t* value = request.data() + valueStart;
+    size_t valueSize = request.size() - valueStart;
+    switch (info.type)
+    {
+        case Attribute::Type::enumeration:
+        {
+            if (valueSize == 0 || valueSize != 1 + size_t{value[0]})
+            {
+                return pldmErrorInvalidLength;
+            }
+            if (value[0] == 0 ||
+                std::any_of(value + 1, value + valueSize, [&](uint8_t index) {
+                    return index >= info.possibleValues;
+                }))
+            {
+                return pldmErrorInvalidData;
+            }
+            break;
+        }
+        case Attribute::Type::string:
+        {
+            if (valueSize < 2 || valueSize != 2 + readLe(value, 2))
+            {
+                return pldmErrorInvalidLength;
+            }
+            if (valueSize - 2 < info.minLength ||
+                valueSize - 2 > info.maxLength)
+            {
+                return pldmErrorInvalidData;
+            }
+            break;
+        }
+        case Attribute::Type::integer:
+        {
+            if (valueSize != 8)
+            {
+                return pldmErrorInvalidLength;
+            }
+            uint64_t current = readLe(value, 8);
+            if (current < info.lowerBound || current > info.upperBound)
+            {
+                return pldmErrorInvalidData;
+            }
+            break;
+        }
+    }
+
+    std::vector<uint8_t>& table = writableValueTable();
+    auto at = table.begin() + static_cast<std::ptrdiff_t>(info.valueOffset);
+    if (valueSize == info.valueSize)
+    {
+        std::copy_n(value, valueSize, at);
+    }
+    else
+    {
+        // The entry changes size, so the entries after it move. They are in
+        // attribute handle order.
+        table.resize(valueTableSize);
+        at = table.begin() + static_cast<std::ptrdiff_t>(info.valueOffset);
+        at = table.erase(at, at + static_cast<std::ptrdiff_t>(info.valueSize));
+        table.insert(at, value, value + valueSize);
+        for (size_t later = handle + 1; later < attributeInfo.size(); later++)
+        {
+            attributeInfo[later].valueOffset =
+                attributeInfo[later].valueOffset + valueSize - info.valueSize;
+        }
+        valueTableSize = valueTableSize + valueSize - info.valueSize;
+        info.valueSize = valueSize;
+    }
+    valueChecksumStale = true;
+    return pldmSuccess;
+}
+
+uint8_t BiosTableResponder::getAttribute(const std::vector<uint8_t>& request,
+                                         std::vector<uint8_t>& out) const
+{
+    if (request.size() != pldmHeaderSize + 7)
+    {
+        return pldmErrorInvalidLength;
+    }
+    if (request[8] != pldmGetFirstPart)
+    {
+        return pldmInvalidTransferOperationFlag;
+    }
+    size_t handle = readLe(&request[9], 2);
+    if (handle >= attributeInfo.size())
+    {
+        return pldmInvalidBiosAttrHandle;
+    }
+
+    // The whole value table entry, its handle and type included
+    const AttributeInfo& info = attributeInfo[handle];
+    auto entry = tables[valueTable]->begin() +
+                 static_cast<std::ptrdiff_t>(info.valueOffset - 3);
+    appendLe(out, 0, 4);
+    out.push_back(pldmTransferStartAndEnd);
+    out.insert(out.end(), entry,
+               entry + static_cast<std::ptrdiff_t>(info.valueSize + 3));
+    return pldmSuccess;
+}
+
+std::optional<MctpResponse>
+    BiosTableResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (!handles(request))
+    {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> out = pldmResponseHeader(request);
+    std::vector<uint8_t> body;
+    switch (request[3])
+    {
+        case pldmGetBiosTable:
+            out[4] = getTable(request, body);
+            break;
+        case pldmSetBiosAttributeCurrentValue:
+            out[4] = setAttribute(request);
+            appendLe(body, 0, 4);
+            break;
+        case pldmGetBiosAttributeCurrentValueByHandle:
+            out[4] = getAttribute(request, body);
+            break;
+    }
+    // Error responses carry the completion code only
+    if (out[4] == pldmSuccess)
+    {
+        out.insert(out.end(), body.begin(), body.end());
+    }
+
+    return MctpResponse{params.processingDelay, std::move(out), {}};
+}
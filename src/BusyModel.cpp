@@ -0,0 +1,118 @@
+#include "BusyModel.hpp"
+
+#include "PldmMessage.hpp"
+#include "libmctp-msgtypes.h"
+
+// SPDM request and error codes
+constexpr uint8_t spdmErrorResponse = 0x7F;
+constexpr uint8_t spdmGetVersion = 0x84;
+constexpr uint8_t spdmGetCapabilities = 0xE1;
+constexpr uint8_t spdmRespondIfReady = 0xFF;
+constexpr uint8_t spdmUnexpectedRequest = 0x04;
+constexpr uint8_t spdmResponseNotReady = 0x42;
+
+BusyModel::BusyModel(const Params& busyParams) :
+    params(busyParams), random(std::random_device{}())
+{}
+
+bool BusyModel::busy()
+{
+    bool loaded = false;
+    if (params.maxRequests != 0)
+    {
+        auto now = std::chrono::steady_clock::now();
+        while (!recent.empty() && now - recent.front() > params.window)
+        {
+            recent.pop_front();
+        }
+        recent.push_back(now);
+        loaded = recent.size() > params.maxRequests;
+    }
+    return loaded ||
+           (params.probability > 0 && chance(random) < params.probability);
+}
+
+MctpResponse BusyModel::spdmError(const std::vector<uint8_t>& request,
+                                  uint8_t errorCode) const
+{
+    // Message type, SPDM version, ERROR, error code, error data
+    std::vector<uint8_t> payload = {request[0], request[1], spdmErrorResponse,
+                                    errorCode, 0x00};
+    return MctpResponse{params.notReadyDelay, std::move(payload), {}};
+}
+
+MctpResponse BusyModel::spdmNotReady(const std::vector<uint8_t>& request,
+                                     uint8_t requestCode, uint8_t token) const
+{
+    MctpResponse response = spdmError(request, spdmResponseNotReady);
+    response.payload.insert(response.payload.end(),
+                            {params.rdtExponent, requestCode, token,
+                             params.rdtm});
+    return response;
+}
+
+BusyModel::Verdict BusyModel::spdm(const std::vector<uint8_t>& request)
+{
+    // Message type, SPDM version, request code, param1, param2
+    uint8_t requestCode = request[2];
+    auto now = std::chrono::steady_clock::now();
+
+    if (requestCode == spdmRespondIfReady)
+    {
+        uint8_t token = request.size() > 4 ? request[4] : 0;
+        auto iter = deferred.find(token);
+        if (request.size() <= 4 || iter == deferred.end() ||
+            iter->second.request[2] != request[3])
+        {
+            return {spdmError(request, spdmUnexpectedRequest), std::nullopt};
+        }
+        if (now < iter->second.readyAt)
+        {
+            // Asked too early, the original request is still not ready
+            return {spdmNotReady(request, request[3], token), std::nullopt};
+        }
+        Verdict verdict{std::nullopt, std::move(iter->second.request)};
+        deferred.erase(iter);
+        return verdict;
+    }
+
+    // These come before the requester knows about RDT
+    if (requestCode == spdmGetVersion || requestCode == spdmGetCapabilities ||
+        !busy())
+    {
+        return {};
+    }
+
+    uint8_t token = nextToken++;
+    auto rdt = std::chrono::microseconds(uint64_t{1} << params.rdtExponent);
+    deferred.insert_or_assign(token, Deferred{request, now + rdt});
+    return {spdmNotReady(request, requestCode, token), std::nullopt};
+}
+
+BusyModel::Verdict BusyModel::intercept(const std::vector<uint8_t>& request)
+{
+    constexpr size_t minSpdmReqSize = 3;
+
+    if (request.empty())
+    {
+        return {};
+    }
+
+    if (request[0] == MCTP_MESSAGE_TYPE_SPDM &&
+        request.size() >= minSpdmReqSize)
+    {
+        return spdm(request);
+    }
+
+    if (request[0] == MCTP_MESSAGE_TYPE_PLDM &&
+        request.size() >= pldmHeaderSize && (request[1] & pldmRequestBit) &&
+        busy())
+    {
+        std::vector<uint8_t> response = pldmResponseHeader(request);
+        response.back() = params.pldmCompletionCode;
+        return {MctpResponse{params.notReadyDelay, std::move(response), {}},
+                std::nullopt};
+    }
+
+    return {};
+}
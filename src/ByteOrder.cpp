@@ -0,0 +1,27 @@
+#include "ByteOrder.hpp"
+
+uint64_t readLe(const uint8_t* data, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+void writeLe(uint8_t* out, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void appendLe(std::vector<uint8_t>& out, uint64_t value, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
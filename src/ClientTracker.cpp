@@ -0,0 +1,90 @@
+#include "ClientTracker.hpp"
+
+#include <phosphor-logging/log.hpp>
+
+ClientTracker::Call::Call(ClientTracker& clientTracker,
+                          const std::string& client) :
+    tracker(clientTracker),
+    name(client)
+{
+    tracker.clients[name].calls++;
+}
+
+ClientTracker::Call::~Call()
+{
+    auto iter = tracker.clients.find(name);
+    if (iter != tracker.clients.end() && --iter->second.calls == 0)
+    {
+        tracker.clients.erase(iter);
+    }
+}
+
+bool ClientTracker::Call::active() const
+{
+    return !tracker.clients.at(name).departed;
+}
+
+bool ClientTracker::Call::wait(std::chrono::milliseconds duration,
+                               boost::asio::yield_context& yield)
+{
+    // Stays put while this call is in progress
+    Client& client = tracker.clients.at(name);
+    if (client.departed)
+    {
+        return false;
+    }
+
+    boost::asio::steady_timer timer(tracker.ioContext, duration);
+    client.waits.insert(&timer);
+    boost::system::error_code ec;
+    timer.async_wait(yield[ec]);
+    client.waits.erase(&timer);
+    return !client.departed;
+}
+
+ClientTracker::ClientTracker(sdbusplus::asio::connection& conn,
+                             DepartureHandler onDeparture) :
+    ioContext(conn.get_io_context()),
+    departure(std::move(onDeparture))
+{
+    ownerMatch = std::make_unique<sdbusplus::bus::match::match>(
+        static_cast<sdbusplus::bus::bus&>(conn),
+        sdbusplus::bus::match::rules::nameOwnerChanged(),
+        [this](sdbusplus::message::message& msg) { nameOwnerChanged(msg); });
+}
+
+void ClientTracker::nameOwnerChanged(sdbusplus::message::message& msg)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    try
+    {
+        msg.read(name, oldOwner, newOwner);
+    }
+    catch (const std::exception&)
+    {
+        return;
+    }
+    // Well-known names change hands, only a unique name going away means
+    // the client is gone
+    if (name.empty() || name.front() != ':' || !newOwner.empty())
+    {
+        return;
+    }
+
+    auto iter = clients.find(name);
+    if (iter != clients.end())
+    {
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            ("mctp-emulator: Requester " + name +
+             " left the bus, cancelling its requests")
+                .c_str());
+        iter->second.departed = true;
+        for (auto* timer : iter->second.waits)
+        {
+            timer->cancel();
+        }
+    }
+    departure(name);
+}
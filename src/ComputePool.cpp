@@ -0,0 +1,134 @@
+#include "ComputePool.hpp"
+
+#include <phosphor-logging/log.hpp>
+#include <string>
+
+// Worker of the pool the current thread belongs to, if any
+static thread_local const ComputePool* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+ComputePool::ComputePool(boost::asio::io_context& ioc, unsigned threadCount) :
+    ioContext(ioc)
+{
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    phosphor::logging::log<phosphor::logging::level::INFO>(
+        ("mctp-emulator: Compute pool started with " +
+         std::to_string(threadCount) + " threads")
+            .c_str());
+}
+
+ComputePool::~ComputePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ComputePool::submit(std::function<void()> task)
+{
+    size_t index;
+    if (currentPool == this)
+    {
+        // Keep follow-up work local, it is likely to share cached data
+        index = currentWorker;
+    }
+    else
+    {
+        index = submitCursor.fetch_add(1, std::memory_order_relaxed) %
+                workers.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->lock);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+        queued.fetch_add(1);
+    }
+    wake.notify_one();
+}
+
+void ComputePool::logTaskFailure(const std::exception& e)
+{
+    phosphor::logging::log<phosphor::logging::level::ERR>(
+        ("mctp-emulator: Compute task failed: " + std::string(e.what()))
+            .c_str());
+}
+
+bool ComputePool::popLocal(size_t index, std::function<void()>& task)
+{
+    Worker& self = *workers[index];
+    std::lock_guard<std::mutex> lock(self.lock);
+    if (self.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(self.tasks.back());
+    self.tasks.pop_back();
+    return true;
+}
+
+bool ComputePool::steal(size_t thief, std::function<void()>& task)
+{
+    for (size_t i = 1; i < workers.size(); i++)
+    {
+        Worker& victim = *workers[(thief + i) % workers.size()];
+        std::unique_lock<std::mutex> lock(victim.lock, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty())
+        {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ComputePool::workerLoop(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (popLocal(index, task) || steal(index, task))
+        {
+            queued.fetch_sub(1);
+            try
+            {
+                task();
+            }
+            catch (const std::exception& e)
+            {
+                logTaskFailure(e);
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepLock);
+        // A steal can miss work behind a contended lock, so only sleep once
+        // nothing is queued anywhere
+        wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0)
+        {
+            return;
+        }
+    }
+}
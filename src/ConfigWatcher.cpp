@@ -0,0 +1,112 @@
+#include "ConfigWatcher.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <phosphor-logging/log.hpp>
+
+// Editors and deployment scripts usually touch a file several times in a row
+// (truncate, write, rename); coalesce those into a single reload.
+constexpr int settleTimeMilliSec = 200;
+
+ConfigWatcher::ConfigWatcher(boost::asio::io_context& ioc,
+                             const std::string& file,
+                             std::function<void()> callback) :
+    onChange(std::move(callback)),
+    inotifyConn(ioc), settleTimer(ioc)
+{
+    std::filesystem::path filePath(file);
+    fileName = filePath.filename().string();
+    std::string dirName = filePath.parent_path().string();
+    if (dirName.empty())
+    {
+        dirName = ".";
+    }
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        std::cerr << "inotify_init1 failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    watchFd = inotify_add_watch(inotifyFd, dirName.c_str(),
+                                IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watchFd < 0)
+    {
+        std::cerr << "unable to watch " << dirName << ": "
+                  << std::strerror(errno) << "\n";
+        close(inotifyFd);
+        inotifyFd = -1;
+        return;
+    }
+
+    inotifyConn.assign(inotifyFd);
+    waitForEvents();
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    settleTimer.cancel();
+    if (inotifyConn.is_open())
+    {
+        // stream_descriptor owns the fd and closes it
+        inotify_rm_watch(inotifyFd, watchFd);
+        inotifyConn.close();
+    }
+}
+
+void ConfigWatcher::waitForEvents()
+{
+    inotifyConn.async_read_some(
+        boost::asio::buffer(readBuf),
+        [this](const boost::system::error_code& ec, std::size_t bytes) {
+            if (ec == boost::asio::error::operation_aborted)
+            {
+                return;
+            }
+            else if (ec)
+            {
+                phosphor::logging::log<phosphor::logging::level::ERR>(
+                    ("mctp-emulator: inotify read failed: " + ec.message())
+                        .c_str());
+                return;
+            }
+
+            bool matched = false;
+            std::size_t offset = 0;
+            while (offset + sizeof(inotify_event) <= bytes)
+            {
+                const auto* event =
+                    reinterpret_cast<const inotify_event*>(&readBuf[offset]);
+                if (event->len > 0 && fileName == event->name)
+                {
+                    matched = true;
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+
+            if (matched)
+            {
+                scheduleReload();
+            }
+            waitForEvents();
+        });
+}
+
+void ConfigWatcher::scheduleReload()
+{
+    settleTimer.expires_after(std::chrono::milliseconds(settleTimeMilliSec));
+    settleTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            // Rescheduled by a newer event, or shutting down
+            return;
+        }
+        onChange();
+    });
+}
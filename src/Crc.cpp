@@ -0,0 +1,78 @@
+#include "Crc.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define CRC32C_SSE42
+#endif
+
+// Byte at a time lookup table of a reflected polynomial
+static constexpr std::array<uint32_t, 256> crcTable(uint32_t polynomial)
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); i++)
+    {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            value = value & 1 ? (value >> 1) ^ polynomial : value >> 1;
+        }
+        table[i] = value;
+    }
+    return table;
+}
+
+static constexpr auto crc32Table = crcTable(0xEDB88320);
+static constexpr auto crc32cTable = crcTable(0x82F63B78);
+
+static uint32_t update(const std::array<uint32_t, 256>& table,
+                       const uint8_t* data, size_t size, uint32_t crc)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc)
+{
+    return update(crc32Table, data, size, crc);
+}
+
+#ifdef CRC32C_SSE42
+// The SSE 4.2 crc32 instruction computes CRC-32C, eight bytes at a time
+__attribute__((target("sse4.2"))) static uint32_t
+    crc32cSse42(const uint8_t* data, size_t size, uint32_t crc)
+{
+    uint64_t value = ~crc;
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        value = _mm_crc32_u64(value, word);
+        data += sizeof(word);
+    }
+    uint32_t tail = static_cast<uint32_t>(value);
+    for (; size > 0; size--)
+    {
+        tail = _mm_crc32_u8(tail, *data++);
+    }
+    return ~tail;
+}
+#endif
+
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc)
+{
+#ifdef CRC32C_SSE42
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    if (hardware)
+    {
+        return crc32cSse42(data, size, crc);
+    }
+#endif
+    return update(crc32cTable, data, size, crc);
+}
@@ -0,0 +1,283 @@
+#include "CxlDevice.hpp"
+
+#include "ByteOrder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// CCI message header following the MCTP message type byte
+constexpr size_t cciHeaderSize = 12;
+constexpr uint8_t cciRequest = 0x00;
+constexpr uint8_t cciResponse = 0x01;
+
+// Return codes
+constexpr uint16_t cxlSuccess = 0x0000;
+constexpr uint16_t cxlInvalidInput = 0x0002;
+constexpr uint16_t cxlUnsupported = 0x0003;
+constexpr uint16_t cxlInvalidPayloadLength = 0x0016;
+
+// Command opcodes
+constexpr uint16_t cxlIdentify = 0x0001;
+constexpr uint16_t cxlGetResponseMessageLimit = 0x0003;
+constexpr uint16_t cxlSetResponseMessageLimit = 0x0004;
+constexpr uint16_t cxlGetTimestamp = 0x0300;
+constexpr uint16_t cxlSetTimestamp = 0x0301;
+constexpr uint16_t cxlGetSupportedLogs = 0x0400;
+constexpr uint16_t cxlGetLog = 0x0401;
+constexpr uint16_t cxlIdentifyMemoryDevice = 0x4000;
+constexpr uint16_t cxlGetHealthInfo = 0x4200;
+
+// Opcodes and command effects reported in the Command Effects Log
+static const std::array<std::pair<uint16_t, uint16_t>, 9> commandEffects = {{
+    {cxlIdentify, 0x0000},
+    {cxlGetResponseMessageLimit, 0x0000},
+    {cxlSetResponseMessageLimit, 0x0002},
+    {cxlGetTimestamp, 0x0000},
+    {cxlSetTimestamp, 0x0008},
+    {cxlGetSupportedLogs, 0x0000},
+    {cxlGetLog, 0x0000},
+    {cxlIdentifyMemoryDevice, 0x0000},
+    {cxlGetHealthInfo, 0x0000},
+}};
+
+using LogId = std::array<uint8_t, 16>;
+static const LogId celLogId = {0x0d, 0xa9, 0xc0, 0xb5, 0xbf, 0x41, 0x4b, 0x78,
+                               0x8f, 0x79, 0x96, 0xb1, 0x62, 0x3b, 0x3f, 0x17};
+static const LogId vendorLogId = {0x5e, 0x1c, 0x6a, 0x2d, 0x0b, 0x47,
+                                  0x4f, 0x3a, 0x9d, 0x21, 0x7c, 0x50,
+                                  0x43, 0x58, 0x4c, 0x01};
+
+// Slices of at least this size are generated on the compute pool
+constexpr uint32_t computeThreshold = 16 * 1024;
+
+// Content of the vendor debug log, a pure function of the offset
+static void fillVendorLog(uint8_t* out, uint32_t offset, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint32_t position = offset + i;
+        out[i] = static_cast<uint8_t>((position * 2654435761U) >> 24);
+    }
+}
+
+CxlDeviceResponder::CxlDeviceResponder(const Params& deviceParams) :
+    params(deviceParams)
+{}
+
+uint16_t CxlDeviceResponder::getLog(const std::vector<uint8_t>& input,
+                                    std::vector<uint8_t>& output,
+                                    bool& deferred) const
+{
+    if (input.size() < 24)
+    {
+        return cxlInvalidPayloadLength;
+    }
+    LogId logId;
+    std::copy_n(input.begin(), logId.size(), logId.begin());
+    auto offset = static_cast<uint32_t>(readLe(&input[16], 4));
+    auto length = static_cast<uint32_t>(readLe(&input[20], 4));
+
+    if (cciHeaderSize + length > (size_t{1} << responseLimit))
+    {
+        return cxlInvalidPayloadLength;
+    }
+
+    if (logId == celLogId)
+    {
+        std::vector<uint8_t> cel;
+        for (const auto& [opcode, effect] : commandEffects)
+        {
+            appendLe(cel, opcode, 2);
+            appendLe(cel, effect, 2);
+        }
+        if (uint64_t{offset} + length > cel.size())
+        {
+            return cxlInvalidInput;
+        }
+        output.insert(output.end(), cel.begin() + offset,
+                      cel.begin() + offset + length);
+        return cxlSuccess;
+    }
+
+    if (logId == vendorLogId)
+    {
+        if (uint64_t{offset} + length > params.vendorLogSize)
+        {
+            return cxlInvalidInput;
+        }
+        size_t start = output.size();
+        output.resize(start + length);
+        if (length >= computeThreshold)
+        {
+            // Filled in by the caller on the compute pool
+            deferred = true;
+        }
+        else
+        {
+            fillVendorLog(&output[start], offset, length);
+        }
+        return cxlSuccess;
+    }
+
+    return cxlUnsupported;
+}
+
+std::optional<MctpResponse>
+    CxlDeviceResponder::respond(const std::vector<uint8_t>& request)
+{
+    // Message type byte and CCI header
+    if (request.size() < 1 + cciHeaderSize ||
+        (request[1] & 0x0F) != cciRequest)
+    {
+        return std::nullopt;
+    }
+    uint8_t tag = request[2];
+    auto opcode = static_cast<uint16_t>(readLe(&request[4], 2));
+    // 21-bit payload length, the bits above it are reserved
+    uint64_t payloadLength = readLe(&request[6], 3) & 0x1FFFFF;
+    std::vector<uint8_t> input(request.begin() + 1 + cciHeaderSize,
+                               request.end());
+
+    std::vector<uint8_t> output = {request[0], cciResponse, tag, 0x00};
+    appendLe(output, opcode, 2);
+    // Payload length and return code are filled in below
+    output.resize(1 + cciHeaderSize, 0);
+
+    uint16_t returnCode = cxlSuccess;
+    bool deferred = false;
+    if (payloadLength != input.size())
+    {
+        returnCode = cxlInvalidPayloadLength;
+    }
+    else
+    {
+        switch (opcode)
+        {
+            case cxlIdentify:
+                appendLe(output, params.vendorId, 2);
+                appendLe(output, params.deviceId, 2);
+                appendLe(output, params.subsystemVendorId, 2);
+                appendLe(output, params.subsystemId, 2);
+                appendLe(output, params.serialNumber, 8);
+                // Max supported message size of requests, 2^n
+                output.push_back(12);
+                // Component type: type 3 device
+                output.push_back(0x03);
+                break;
+            case cxlGetResponseMessageLimit:
+                output.push_back(responseLimit);
+                break;
+            case cxlSetResponseMessageLimit:
+                if (input.size() != 1 || input[0] < 8 || input[0] > 20)
+                {
+                    returnCode = cxlInvalidInput;
+                    break;
+                }
+                responseLimit = input[0];
+                output.push_back(responseLimit);
+                break;
+            case cxlGetTimestamp:
+            {
+                uint64_t now = timestampBase;
+                if (timestampBase != 0)
+                {
+                    now += static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - timestampSetAt)
+                            .count());
+                }
+                appendLe(output, now, 8);
+                break;
+            }
+            case cxlSetTimestamp:
+                if (input.size() != 8)
+                {
+                    returnCode = cxlInvalidPayloadLength;
+                    break;
+                }
+                timestampBase = readLe(input.data(), 8);
+                timestampSetAt = std::chrono::steady_clock::now();
+                break;
+            case cxlGetSupportedLogs:
+                appendLe(output, 2, 2);
+                output.resize(output.size() + 6, 0);
+                output.insert(output.end(), celLogId.begin(), celLogId.end());
+                appendLe(output, commandEffects.size() * 4, 4);
+                output.insert(output.end(), vendorLogId.begin(),
+                              vendorLogId.end());
+                appendLe(output, params.vendorLogSize, 4);
+                break;
+            case cxlGetLog:
+                returnCode = getLog(input, output, deferred);
+                break;
+            case cxlIdentifyMemoryDevice:
+            {
+                std::array<char, 16> revision{};
+                std::memcpy(revision.data(), params.firmwareRevision.data(),
+                            std::min(revision.size(),
+                                     params.firmwareRevision.size()));
+                output.insert(output.end(), revision.begin(), revision.end());
+                appendLe(output, params.capacity, 8);
+                // Volatile only, persistent only, partition alignment
+                appendLe(output, params.capacity, 8);
+                appendLe(output, 0, 8);
+                appendLe(output, 0, 8);
+                // Informational, warning, failure and fatal event log sizes
+                for (int log = 0; log < 4; log++)
+                {
+                    appendLe(output, 32, 2);
+                }
+                // LSA size, poison list size, inject poison limit, poison
+                // handling and QoS telemetry capabilities
+                appendLe(output, 0, 4);
+                appendLe(output, 0, 3);
+                appendLe(output, 0, 2);
+                output.push_back(0);
+                output.push_back(0);
+                break;
+            }
+            case cxlGetHealthInfo:
+                output.push_back(params.healthStatus);
+                output.push_back(params.mediaStatus);
+                // Additional status
+                output.push_back(0);
+                output.push_back(params.lifeUsed);
+                appendLe(output, static_cast<uint16_t>(params.temperature), 2);
+                appendLe(output, params.dirtyShutdownCount, 4);
+                // Corrected volatile and persistent error counts
+                appendLe(output, 0, 4);
+                appendLe(output, 0, 4);
+                break;
+            default:
+                returnCode = cxlUnsupported;
+                break;
+        }
+    }
+
+    if (returnCode != cxlSuccess)
+    {
+        output.resize(1 + cciHeaderSize);
+        deferred = false;
+    }
+    writeLe(&output[6], output.size() - 1 - cciHeaderSize, 3);
+    writeLe(&output[9], returnCode, 2);
+
+    MctpResponse response;
+    response.processingDelay = params.processingDelay;
+    if (deferred)
+    {
+        auto offset = static_cast<uint32_t>(readLe(&input[16], 4));
+        response.compute = [output = std::move(output), offset]() mutable
+            -> std::optional<std::vector<uint8_t>> {
+            size_t start = 1 + cciHeaderSize;
+            fillVendorLog(&output[start], offset,
+                          static_cast<uint32_t>(output.size() - start));
+            return std::move(output);
+        };
+    }
+    else
+    {
+        response.payload = std::move(output);
+    }
+    return response;
+}
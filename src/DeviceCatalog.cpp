@@ -0,0 +1,84 @@
+#include "DeviceCatalog.hpp"
+
+DeviceCatalog deviceCatalog;
+
+// Parameters are taken by value, the coroutine frame keeps its own copy
+static DeviceCoroutine counterDevice(std::chrono::milliseconds responseDelay)
+{
+    uint8_t count = 0;
+    for (;;)
+    {
+        const auto& request = co_await nextRequest();
+        if (request.size() < 2)
+        {
+            continue;
+        }
+        co_await delay(responseDelay);
+        std::vector<uint8_t> response{request[0], request[1], ++count};
+        co_yield response;
+    }
+}
+
+static DeviceCoroutine
+    sequenceDevice(std::vector<std::optional<std::vector<uint8_t>>> responses,
+                   std::chrono::milliseconds responseDelay)
+{
+    if (responses.empty())
+    {
+        co_return;
+    }
+    for (;;)
+    {
+        for (const auto& response : responses)
+        {
+            co_await nextRequest();
+            if (response)
+            {
+                co_await delay(responseDelay);
+                co_yield *response;
+            }
+        }
+    }
+}
+
+DeviceCatalog::DeviceCatalog()
+{
+    add("Counter", [](const nlohmann::json& params) {
+        return counterDevice(
+            std::chrono::milliseconds(params.value("Delay", 0)));
+    });
+    add("Sequence", [](const nlohmann::json& params) {
+        std::vector<std::optional<std::vector<uint8_t>>> responses;
+        for (const auto& response : params.at("Responses"))
+        {
+            if (response.is_null())
+            {
+                responses.emplace_back(std::nullopt);
+            }
+            else
+            {
+                responses.emplace_back(response.get<std::vector<uint8_t>>());
+            }
+        }
+        return sequenceDevice(
+            std::move(responses),
+            std::chrono::milliseconds(params.value("Delay", 0)));
+    });
+}
+
+void DeviceCatalog::add(std::string name, Factory factory)
+{
+    factories.insert_or_assign(std::move(name), std::move(factory));
+}
+
+std::optional<DeviceCoroutine>
+    DeviceCatalog::create(const std::string& name,
+                          const nlohmann::json& params) const
+{
+    auto iter = factories.find(name);
+    if (iter == factories.end())
+    {
+        return std::nullopt;
+    }
+    return iter->second(params);
+}
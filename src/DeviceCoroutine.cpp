@@ -0,0 +1,45 @@
+#include "DeviceCoroutine.hpp"
+
+#include <phosphor-logging/log.hpp>
+
+std::optional<MctpResponse>
+    DeviceCoroutine::resume(const std::vector<uint8_t>& request)
+{
+    if (done())
+    {
+        return std::nullopt;
+    }
+
+    promise_type& promise = handle.promise();
+    promise.request = &request;
+    promise.requestTaken = false;
+    promise.response.reset();
+
+    handle.resume();
+
+    // Whatever the device kept of the request is stale from here on
+    promise.request = nullptr;
+
+    if (promise.failure)
+    {
+        try
+        {
+            std::rethrow_exception(std::exchange(promise.failure, nullptr));
+        }
+        catch (std::exception& e)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                (std::string("mctp-emulator: Device coroutine failed: ") +
+                 e.what())
+                    .c_str());
+        }
+        catch (...)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "mctp-emulator: Device coroutine failed");
+        }
+        return std::nullopt;
+    }
+
+    return std::exchange(promise.response, std::nullopt);
+}
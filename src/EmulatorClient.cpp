@@ -0,0 +1,206 @@
+#include "EmulatorClient.hpp"
+
+#include <boost/asio/error.hpp>
+#include <cmath>
+
+static const std::string mctpObj = "/xyz/openbmc_project/mctp";
+static const std::string mctpIntf = "xyz.openbmc_project.MCTP.Base";
+
+std::chrono::nanoseconds EmulatorClient::LatencyStats::mean() const
+{
+    if (completed == 0)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+    return total / completed;
+}
+
+std::chrono::microseconds
+    EmulatorClient::LatencyStats::percentile(double pct) const
+{
+    uint64_t target = static_cast<uint64_t>(
+        std::ceil(static_cast<double>(completed) * pct / 100.0));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < bucketCount; bucket++)
+    {
+        seen += histogram[bucket];
+        if (seen >= target && seen > 0)
+        {
+            return std::chrono::microseconds(uint64_t{1} << bucket);
+        }
+    }
+    return std::chrono::microseconds::zero();
+}
+
+EmulatorClient::EmulatorClient(
+    std::shared_ptr<sdbusplus::asio::connection> conn, uint8_t tagMask,
+    std::string service) :
+    connection(std::move(conn)),
+    serviceName(std::move(service)), allowedTags(tagMask),
+    slots(256 * tagCount), backlog(256)
+{
+    namespace rules = sdbusplus::bus::match::rules;
+    responseMatch = std::make_unique<sdbusplus::bus::match::match>(
+        static_cast<sdbusplus::bus::bus&>(*connection),
+        rules::type::signal() + rules::sender(serviceName) +
+            rules::path(mctpObj) + rules::interface(mctpIntf) +
+            rules::member("MessageReceivedSignal"),
+        [this](sdbusplus::message::message& msg) { onResponse(msg); });
+}
+
+EmulatorClient::~EmulatorClient()
+{
+    for (auto& slot : slots)
+    {
+        if (slot.timer)
+        {
+            slot.timer->cancel();
+        }
+    }
+}
+
+void EmulatorClient::send(uint8_t dstEid, std::vector<uint8_t> payload,
+                          std::chrono::milliseconds timeout, Callback callback)
+{
+    Request request{dstEid, std::move(payload), timeout, std::move(callback)};
+
+    size_t base = static_cast<size_t>(dstEid) * tagCount;
+    for (uint8_t tag = 0; tag < tagCount; tag++)
+    {
+        if ((allowedTags & (1 << tag)) && !slots[base + tag].busy)
+        {
+            dispatch(dstEid, tag, std::move(request));
+            return;
+        }
+    }
+    backlog[dstEid].push_back(std::move(request));
+}
+
+void EmulatorClient::dispatch(uint8_t dstEid, uint8_t tag, Request request)
+{
+    size_t index = static_cast<size_t>(dstEid) * tagCount + tag;
+    Slot& slot = slots[index];
+    slot.busy = true;
+    slot.generation++;
+    slot.callback = std::move(request.callback);
+    slot.sent = std::chrono::steady_clock::now();
+    inFlight++;
+
+    if (!slot.timer)
+    {
+        slot.timer = std::make_unique<boost::asio::steady_timer>(
+            connection->get_io_context());
+    }
+    uint64_t generation = slot.generation;
+    slot.timer->expires_after(request.timeout);
+    slot.timer->async_wait(
+        [this, weak = std::weak_ptr<bool>(alive), index,
+         generation](const boost::system::error_code& ec) {
+            if (ec || weak.expired() || !slots[index].busy ||
+                slots[index].generation != generation)
+            {
+                return;
+            }
+            complete(index, boost::asio::error::timed_out, {});
+        });
+
+    constexpr bool tagOwner = true;
+    connection->async_method_call(
+        [this, weak = std::weak_ptr<bool>(alive), index,
+         generation](boost::system::error_code ec, int rc) {
+            if (weak.expired() || !slots[index].busy ||
+                slots[index].generation != generation)
+            {
+                return;
+            }
+            if (ec)
+            {
+                complete(index, ec, {});
+            }
+            else if (rc != 0)
+            {
+                // The emulator found nothing to answer with
+                complete(index,
+                         boost::system::errc::make_error_code(
+                             boost::system::errc::bad_message),
+                         {});
+            }
+        },
+        serviceName, mctpObj, mctpIntf, "SendMctpMessagePayload", dstEid, tag,
+        tagOwner, request.payload);
+}
+
+void EmulatorClient::complete(size_t index, boost::system::error_code ec,
+                              std::vector<uint8_t> response)
+{
+    Slot& slot = slots[index];
+    slot.busy = false;
+    slot.timer->cancel();
+    inFlight--;
+
+    if (!ec)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - slot.sent;
+        stats.completed++;
+        stats.min = std::min(stats.min, elapsed);
+        stats.max = std::max(stats.max, elapsed);
+        stats.total += elapsed;
+        auto micros =
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                .count();
+        size_t bucket = 0;
+        while (bucket + 1 < LatencyStats::bucketCount &&
+               (int64_t{1} << bucket) < micros)
+        {
+            bucket++;
+        }
+        stats.histogram[bucket]++;
+    }
+    else if (ec == boost::asio::error::timed_out)
+    {
+        stats.timeouts++;
+    }
+    else
+    {
+        stats.errors++;
+    }
+
+    Callback callback = std::move(slot.callback);
+    slot.callback = nullptr;
+
+    // Hand the freed tag to the next waiting request before running the
+    // callback, which may well queue more
+    uint8_t dstEid = static_cast<uint8_t>(index / tagCount);
+    uint8_t tag = static_cast<uint8_t>(index % tagCount);
+    auto& waiting = backlog[dstEid];
+    if (!waiting.empty())
+    {
+        Request next = std::move(waiting.front());
+        waiting.pop_front();
+        dispatch(dstEid, tag, std::move(next));
+    }
+
+    callback(ec, std::move(response));
+}
+
+void EmulatorClient::onResponse(sdbusplus::message::message& msg)
+{
+    uint8_t msgType = 0;
+    uint8_t srcEid = 0;
+    uint8_t msgTag = 0;
+    bool tagOwner = false;
+    std::vector<uint8_t> response;
+    msg.read(msgType, srcEid, msgTag, tagOwner, response);
+
+    // Responses to our requests come back with tag owner cleared
+    if (tagOwner || msgTag >= tagCount)
+    {
+        return;
+    }
+    size_t index = static_cast<size_t>(srcEid) * tagCount + msgTag;
+    if (!slots[index].busy)
+    {
+        return;
+    }
+    complete(index, {}, std::move(response));
+}
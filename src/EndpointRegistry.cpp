@@ -0,0 +1,113 @@
+#include "EndpointRegistry.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+std::atomic<uint64_t> EndpointRegistry::globalEpoch{1};
+std::array<EndpointRegistry::ReaderSlot, EndpointRegistry::maxReaderThreads>
+    EndpointRegistry::readerSlots;
+
+EndpointRegistry endpointRegistry;
+
+EndpointRegistry::ThreadSlot::~ThreadSlot()
+{
+    if (slot != nullptr)
+    {
+        slot->epoch.store(idleEpoch, std::memory_order_release);
+        slot->claimed.store(false, std::memory_order_release);
+    }
+}
+
+EndpointRegistry::ThreadSlot& EndpointRegistry::threadSlot()
+{
+    thread_local ThreadSlot self;
+    if (self.slot == nullptr)
+    {
+        for (auto& candidate : readerSlots)
+        {
+            bool expected = false;
+            if (candidate.claimed.compare_exchange_strong(expected, true))
+            {
+                self.slot = &candidate;
+                break;
+            }
+        }
+        if (self.slot == nullptr)
+        {
+            throw std::runtime_error("EndpointRegistry: out of reader slots");
+        }
+    }
+    return self;
+}
+
+EndpointRegistry::EndpointRegistry() : current(new EndpointMap())
+{
+}
+
+EndpointRegistry::~EndpointRegistry()
+{
+    // No readers can be left once the registry itself goes away
+    delete current.load();
+    for (auto& [snapshot, epoch] : retired)
+    {
+        delete snapshot;
+    }
+}
+
+EndpointRegistry::ReadGuard EndpointRegistry::read() const
+{
+    ThreadSlot& self = threadSlot();
+    if (self.depth++ == 0)
+    {
+        // seq_cst: the epoch store must be ordered before the pointer load,
+        // pairing with the exchange/fetch_add in publish()
+        self.slot->epoch.store(globalEpoch.load());
+    }
+    return ReadGuard(current.load());
+}
+
+EndpointRegistry::ReadGuard::~ReadGuard()
+{
+    ThreadSlot& self = threadSlot();
+    if (--self.depth == 0)
+    {
+        self.slot->epoch.store(idleEpoch, std::memory_order_release);
+    }
+}
+
+void EndpointRegistry::publish(EndpointMap endpoints)
+{
+    auto next = new EndpointMap(std::move(endpoints));
+
+    std::lock_guard<std::mutex> lock(writeLock);
+    const EndpointMap* previous = current.exchange(next);
+    // Any reader which may hold previous entered at or before this epoch
+    uint64_t retiredAt = globalEpoch.fetch_add(1);
+    retired.emplace_back(previous, retiredAt);
+    reclaimLocked();
+}
+
+void EndpointRegistry::reclaimLocked()
+{
+    uint64_t oldestReader = std::numeric_limits<uint64_t>::max();
+    for (const auto& slot : readerSlots)
+    {
+        uint64_t epoch = slot.epoch.load();
+        if (epoch != idleEpoch)
+        {
+            oldestReader = std::min(oldestReader, epoch);
+        }
+    }
+
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [oldestReader](const auto& entry) {
+                                     if (entry.second >= oldestReader)
+                                     {
+                                         return false;
+                                     }
+                                     delete entry.first;
+                                     return true;
+                                 }),
+                  retired.end());
+}
@@ -0,0 +1,213 @@
+#include "EthernetBridge.hpp"
+
+#include <fcntl.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <array>
+#include <boost/asio/post.hpp>
+#include <cerrno>
+#include <cstring>
+#include <phosphor-logging/log.hpp>
+#include <system_error>
+
+#include "libmctp-msgtypes.h"
+
+// Frames drained from the TAP device per readiness event
+constexpr size_t readBatch = 64;
+// Bound on frames waiting for the emulated link per direction, the rest is
+// dropped like a congested NIC would
+constexpr size_t maxQueuedFrames = 4096;
+
+static int openTap(const std::string& tapName)
+{
+    int fd = ::open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "open /dev/net/tun");
+    }
+
+    ifreq request{};
+    request.ifr_flags = IFF_TAP | IFF_NO_PI;
+    std::strncpy(request.ifr_name, tapName.c_str(), IFNAMSIZ - 1);
+    if (::ioctl(fd, TUNSETIFF, &request) < 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "TUNSETIFF " + tapName);
+    }
+    return fd;
+}
+
+EthernetBridge::EthernetBridge(boost::asio::io_context& ioc,
+                               const std::string& tapName,
+                               std::shared_ptr<const LinkTimingModel> link,
+                               FrameHandler toRequester) :
+    ioContext(ioc),
+    tap(ioc, openTap(tapName)), linkTimer(ioc), linkModel(std::move(link)),
+    onFrame(std::move(toRequester))
+{}
+
+void EthernetBridge::start()
+{
+    waitForFrames();
+}
+
+void EthernetBridge::close()
+{
+    closed = true;
+    linkTimer.cancel();
+    tap.close();
+    toTap.clear();
+    fromTap.clear();
+}
+
+std::chrono::steady_clock::time_point
+    EthernetBridge::scheduleOnLink(size_t bytes, bool fromEndpoint)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto start = std::max(now, linkBusyUntil);
+    if (linkModel)
+    {
+        linkBusyUntil = start + linkModel->transferTime(bytes, fromEndpoint);
+    }
+    else
+    {
+        linkBusyUntil = start;
+    }
+    return linkBusyUntil;
+}
+
+void EthernetBridge::fromRequester(std::vector<uint8_t> frame)
+{
+    boost::asio::post(ioContext, [self = shared_from_this(),
+                                  frame = std::move(frame)]() mutable {
+        if (self->closed || self->toTap.size() >= maxQueuedFrames)
+        {
+            return;
+        }
+        auto due = self->scheduleOnLink(frame.size(), false);
+        // Strip the message type byte, the TAP device takes plain frames
+        frame.erase(frame.begin());
+        self->toTap.push_back(Frame{due, std::move(frame)});
+        self->armTimer();
+    });
+}
+
+void EthernetBridge::waitForFrames()
+{
+    tap.async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                   [self = shared_from_this()](
+                       const boost::system::error_code& ec) {
+                       if (ec || self->closed)
+                       {
+                           return;
+                       }
+                       self->readFrames();
+                       self->waitForFrames();
+                   });
+}
+
+void EthernetBridge::readFrames()
+{
+    std::array<uint8_t, 65536> buffer;
+    for (size_t count = 0; count < readBatch; count++)
+    {
+        ssize_t bytes = ::read(tap.native_handle(), buffer.data(),
+                               buffer.size());
+        if (bytes <= 0)
+        {
+            if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                phosphor::logging::log<phosphor::logging::level::ERR>(
+                    (std::string("mctp-emulator: TAP read failed: ") +
+                     std::strerror(errno))
+                        .c_str());
+            }
+            break;
+        }
+        if (fromTap.size() >= maxQueuedFrames)
+        {
+            continue;
+        }
+
+        std::vector<uint8_t> frame;
+        frame.reserve(static_cast<size_t>(bytes) + 1);
+        frame.push_back(MCTP_MESSAGE_TYPE_ETHERNET);
+        frame.insert(frame.end(), buffer.begin(), buffer.begin() + bytes);
+        auto due = scheduleOnLink(frame.size(), true);
+        fromTap.push_back(Frame{due, std::move(frame)});
+    }
+    armTimer();
+}
+
+void EthernetBridge::armTimer()
+{
+    if (toTap.empty() && fromTap.empty())
+    {
+        return;
+    }
+    auto next = std::chrono::steady_clock::time_point::max();
+    if (!toTap.empty())
+    {
+        next = toTap.front().due;
+    }
+    if (!fromTap.empty())
+    {
+        next = std::min(next, fromTap.front().due);
+    }
+    if (next <= std::chrono::steady_clock::now())
+    {
+        flush();
+        return;
+    }
+
+    linkTimer.expires_at(next);
+    linkTimer.async_wait(
+        [self = shared_from_this()](const boost::system::error_code& ec) {
+            if (ec || self->closed)
+            {
+                return;
+            }
+            self->flush();
+        });
+}
+
+void EthernetBridge::flush()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    while (!toTap.empty() && toTap.front().due <= now)
+    {
+        const auto& frame = toTap.front().bytes;
+        if (::write(tap.native_handle(), frame.data(), frame.size()) < 0 &&
+            errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                (std::string("mctp-emulator: TAP write failed: ") +
+                 std::strerror(errno))
+                    .c_str());
+        }
+        toTap.pop_front();
+    }
+
+    while (!fromTap.empty() && fromTap.front().due <= now)
+    {
+        onFrame(std::move(fromTap.front().bytes));
+        fromTap.pop_front();
+    }
+
+    armTimer();
+}
+
+std::optional<MctpResponse>
+    EthernetBridgeResponder::respond(const std::vector<uint8_t>& request)
+{
+    bridge->fromRequester(request);
+    // Frames are not answered
+    return MctpResponse{-1, {}, {}};
+}
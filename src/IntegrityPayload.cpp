@@ -0,0 +1,152 @@
+#include "IntegrityPayload.hpp"
+
+#include "Crc.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static void storeLe(uint8_t* out, uint32_t value)
+{
+    for (size_t i = 0; i < sizeof(value); i++)
+    {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint32_t loadLe(const uint8_t* data)
+{
+    return uint32_t{data[0]} | uint32_t{data[1]} << 8 |
+           uint32_t{data[2]} << 16 | uint32_t{data[3]} << 24;
+}
+
+std::vector<uint8_t> IntegrityPayload::make(uint8_t msgType, uint32_t sequence,
+                                            size_t size)
+{
+    size = std::max(size, minSize);
+    std::vector<uint8_t> payload(size);
+    payload[0] = msgType;
+    storeLe(&payload[sequenceOffset], sequence);
+    storeLe(&payload[lengthOffset], static_cast<uint32_t>(size));
+
+    // xorshift64 seeded by the sequence, so that no two payloads carry the
+    // same data and a stale buffer can't pass for a fresh one
+    uint64_t state = (uint64_t{sequence} + 1) * 0x9E3779B97F4A7C15;
+    size_t end = size - crcSize;
+    for (size_t i = dataOffset; i < end; i += sizeof(state))
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::memcpy(&payload[i], &state, std::min(sizeof(state), end - i));
+    }
+
+    storeLe(&payload[end], crc32c(payload.data(), end));
+    return payload;
+}
+
+void IntegrityVerifier::addGap(Endpoint& endpoint, uint32_t first,
+                               uint32_t count)
+{
+    if (endpoint.gaps.size() == maxGaps)
+    {
+        endpoint.gaps.erase(endpoint.gaps.begin());
+    }
+    endpoint.gaps.push_back(Gap{first, count});
+}
+
+bool IntegrityVerifier::fillGap(Endpoint& endpoint, uint32_t sequence)
+{
+    for (auto gap = endpoint.gaps.begin(); gap != endpoint.gaps.end(); gap++)
+    {
+        uint32_t offset = sequence - gap->first;
+        if (offset >= gap->count)
+        {
+            continue;
+        }
+        if (gap->count == 1)
+        {
+            endpoint.gaps.erase(gap);
+        }
+        else if (offset == 0)
+        {
+            gap->first++;
+            gap->count--;
+        }
+        else if (offset == gap->count - 1)
+        {
+            gap->count--;
+        }
+        else
+        {
+            Gap after{sequence + 1, gap->count - offset - 1};
+            gap->count = offset;
+            endpoint.gaps.insert(gap + 1, after);
+        }
+        return true;
+    }
+    return false;
+}
+
+IntegrityVerifier::Result
+    IntegrityVerifier::check(uint8_t eid, const std::vector<uint8_t>& payload)
+{
+    using Payload = IntegrityPayload;
+    if (payload.size() < Payload::minSize ||
+        loadLe(&payload[Payload::lengthOffset]) != payload.size())
+    {
+        counters.truncated++;
+        return Result::truncated;
+    }
+    size_t end = payload.size() - Payload::crcSize;
+    if (loadLe(&payload[end]) != crc32c(payload.data(), end))
+    {
+        counters.corrupted++;
+        return Result::corrupted;
+    }
+    counters.verified++;
+    counters.bytes += payload.size();
+
+    uint32_t sequence = loadLe(&payload[Payload::sequenceOffset]);
+    Endpoint& endpoint = endpoints[eid];
+    std::optional<uint32_t> expected = endpoint.nextSequence;
+    endpoint.nextSequence = sequence + 1;
+    if (!expected || sequence == *expected)
+    {
+        return Result::ok;
+    }
+
+    // Modulo 2^32, so the counter may wrap
+    uint32_t ahead = sequence - *expected;
+    if (ahead < 0x80000000)
+    {
+        addGap(endpoint, *expected, ahead);
+        counters.missing += ahead;
+        return Result::gap;
+    }
+
+    if (fillGap(endpoint, sequence))
+    {
+        endpoint.nextSequence = expected;
+        counters.missing--;
+        counters.reordered++;
+        return Result::reordered;
+    }
+
+    // Every sequence number is sent once, an earlier one that wasn't
+    // skipped comes from a new instance of the endpoint. What the old one
+    // still owes stays missing.
+    endpoint.gaps.clear();
+    if (sequence > 0)
+    {
+        addGap(endpoint, 0, sequence);
+        counters.missing += sequence;
+    }
+    counters.restarts++;
+    return Result::restarted;
+}
+
+void IntegrityVerifier::reset()
+{
+    counters = Stats{};
+    endpoints.fill(Endpoint{});
+}
@@ -0,0 +1,121 @@
+#include "LinkTimingModel.hpp"
+
+#include <cmath>
+
+using nanoseconds = std::chrono::duration<double, std::nano>;
+
+static std::chrono::microseconds toMicroseconds(nanoseconds time)
+{
+    return std::chrono::microseconds(
+        static_cast<int64_t>(std::ceil(time.count() / 1000.0)));
+}
+
+I3CTimingModel::I3CTimingModel(const Params& linkParams) : params(linkParams)
+{
+}
+
+std::chrono::microseconds
+    I3CTimingModel::transferTime(size_t bytes, bool endpointInitiated) const
+{
+    // SDR bytes carry a T bit, HDR-DDR moves 16 bit words framed by 2
+    // preamble and 2 parity bits at two bits per clock
+    constexpr double sdrBitsPerByte = 9;
+    constexpr double hdrBitsPerByte = 10;
+    // START, 7'h7E broadcast, Sr and target address, each acknowledged
+    constexpr double sdrHeaderBits = 20;
+    // ENTHDR0 CCC in SDR, then command and CRC words and the exit pattern
+    constexpr double hdrEntryBits = 18;
+    constexpr double hdrOverheadBits = 60;
+    // IBI address header and mandatory data byte
+    constexpr double ibiBits = 18;
+    constexpr size_t pecSize = 1;
+
+    const double clockNs = 1e9 / params.clockHz;
+    nanoseconds total{0};
+
+    forEachPacket(bytes, params.mtu, [&](size_t packet) {
+        double wire = static_cast<double>(packet + pecSize);
+        if (params.hdrDdr)
+        {
+            total += nanoseconds(
+                (sdrHeaderBits + hdrEntryBits) * clockNs +
+                (hdrOverheadBits + wire * hdrBitsPerByte) * clockNs / 2);
+        }
+        else
+        {
+            total += nanoseconds((sdrHeaderBits + wire * sdrBitsPerByte) *
+                                 clockNs);
+        }
+
+        if (endpointInitiated)
+        {
+            total += nanoseconds(ibiBits * clockNs) +
+                     std::chrono::microseconds(params.ibiLatencyUs);
+        }
+    });
+
+    return toMicroseconds(total);
+}
+
+UsbTimingModel::UsbTimingModel(const Params& linkParams) : params(linkParams)
+{
+}
+
+std::chrono::microseconds
+    UsbTimingModel::transferTime(size_t bytes, bool endpointInitiated) const
+{
+    // DMTF vendor ID, reserved and length
+    constexpr size_t usbHeaderSize = 4;
+    // Token, data PID/CRC16 and handshake packets with SYNC and EOP, in bytes
+    constexpr double transactionOverhead = 20;
+
+    const double byteNs = params.highSpeed ? 8e9 / 480e6 : 8e9 / 12e6;
+    nanoseconds total{0};
+
+    forEachPacket(bytes, params.mtu, [&](size_t packet) {
+        size_t transfer = usbHeaderSize + packet;
+        size_t usbPackets =
+            (transfer + params.maxPacketSize - 1) / params.maxPacketSize;
+
+        total += nanoseconds(
+            (static_cast<double>(transfer) +
+             static_cast<double>(usbPackets) * transactionOverhead) *
+            byteNs);
+        total += std::chrono::microseconds(params.transferOverheadUs);
+        if (endpointInitiated)
+        {
+            // The host polls the IN endpoint once per interval, on average
+            // the transfer waits half of it
+            total += std::chrono::microseconds(params.inPollIntervalUs) / 2;
+        }
+    });
+
+    return toMicroseconds(total);
+}
+
+KcsTimingModel::KcsTimingModel(const Params& linkParams) : params(linkParams)
+{
+}
+
+std::chrono::microseconds
+    KcsTimingModel::transferTime(size_t bytes, bool endpointInitiated) const
+{
+    // NetFn/LUN, defining body and length ahead of the packet, PEC after it
+    constexpr size_t kcsFraming = 4;
+    // WRITE_START and WRITE_END control codes
+    constexpr size_t controlCodes = 2;
+
+    std::chrono::microseconds total{0};
+
+    forEachPacket(bytes, params.mtu, [&](size_t packet) {
+        size_t handshakes = packet + kcsFraming + controlCodes;
+        total += std::chrono::microseconds(params.byteLatencyUs) *
+                 static_cast<int64_t>(handshakes);
+        if (endpointInitiated)
+        {
+            total += std::chrono::microseconds(params.attentionLatencyUs);
+        }
+    });
+
+    return total;
+}
@@ -0,0 +1,297 @@
+#include "LuaResponder.hpp"
+
+#include <lua.hpp>
+#include <phosphor-logging/log.hpp>
+#include <stdexcept>
+
+#include "libmctp-msgtypes.h"
+
+static constexpr const char* requestMeta = "mctp.request";
+static constexpr const char* responseMeta = "mctp.response";
+
+// Buffers handed to scripts. They only point at the C++ vectors for the
+// duration of a call and are invalidated afterwards.
+struct RequestView
+{
+    const uint8_t* data;
+    size_t size;
+};
+
+struct ResponseView
+{
+    std::vector<uint8_t>* bytes;
+};
+
+static int requestIndex(lua_State* state)
+{
+    auto* view =
+        static_cast<RequestView*>(luaL_checkudata(state, 1, requestMeta));
+    lua_Integer index = luaL_checkinteger(state, 2);
+    if (view->data == nullptr || index < 1 ||
+        static_cast<size_t>(index) > view->size)
+    {
+        lua_pushnil(state);
+        return 1;
+    }
+    lua_pushinteger(state, view->data[index - 1]);
+    return 1;
+}
+
+static int requestLength(lua_State* state)
+{
+    auto* view =
+        static_cast<RequestView*>(luaL_checkudata(state, 1, requestMeta));
+    lua_pushinteger(state, static_cast<lua_Integer>(view->size));
+    return 1;
+}
+
+static int responseIndex(lua_State* state)
+{
+    auto* view =
+        static_cast<ResponseView*>(luaL_checkudata(state, 1, responseMeta));
+    lua_Integer index = luaL_checkinteger(state, 2);
+    if (view->bytes == nullptr || index < 1 ||
+        static_cast<size_t>(index) > view->bytes->size())
+    {
+        lua_pushnil(state);
+        return 1;
+    }
+    lua_pushinteger(state, (*view->bytes)[static_cast<size_t>(index - 1)]);
+    return 1;
+}
+
+static int responseNewIndex(lua_State* state)
+{
+    // MCTP messages are at most a few kilobytes, this only catches typos
+    constexpr lua_Integer maxResponseSize = 64 * 1024;
+
+    auto* view =
+        static_cast<ResponseView*>(luaL_checkudata(state, 1, responseMeta));
+    lua_Integer index = luaL_checkinteger(state, 2);
+    lua_Integer value = luaL_checkinteger(state, 3);
+    luaL_argcheck(state, view->bytes != nullptr, 1, "response expired");
+    luaL_argcheck(state, index >= 1 && index <= maxResponseSize, 2,
+                  "index out of range");
+    luaL_argcheck(state, value >= 0 && value <= 0xFF, 3, "not a byte");
+
+    auto position = static_cast<size_t>(index - 1);
+    if (position >= view->bytes->size())
+    {
+        view->bytes->resize(position + 1, 0);
+    }
+    (*view->bytes)[position] = static_cast<uint8_t>(value);
+    return 0;
+}
+
+static int responseLength(lua_State* state)
+{
+    auto* view =
+        static_cast<ResponseView*>(luaL_checkudata(state, 1, responseMeta));
+    lua_Integer size = 0;
+    if (view->bytes != nullptr)
+    {
+        size = static_cast<lua_Integer>(view->bytes->size());
+    }
+    lua_pushinteger(state, size);
+    return 1;
+}
+
+static void budgetExceeded(lua_State* state, lua_Debug*)
+{
+    luaL_error(state, "instruction budget exceeded");
+}
+
+// Error object on top of the stack, which scripts may raise as any value
+static std::string errorMessage(lua_State* state)
+{
+    const char* message = lua_tostring(state, -1);
+    return message != nullptr ? message : "error object is not a string";
+}
+
+LuaEndpointState::LuaEndpointState() : state(luaL_newstate())
+{
+    if (state == nullptr)
+    {
+        throw std::runtime_error("unable to create Lua state");
+    }
+    luaL_openlibs(state);
+
+    luaL_newmetatable(state, requestMeta);
+    lua_pushcfunction(state, requestIndex);
+    lua_setfield(state, -2, "__index");
+    lua_pushcfunction(state, requestLength);
+    lua_setfield(state, -2, "__len");
+    lua_pop(state, 1);
+
+    luaL_newmetatable(state, responseMeta);
+    lua_pushcfunction(state, responseIndex);
+    lua_setfield(state, -2, "__index");
+    lua_pushcfunction(state, responseNewIndex);
+    lua_setfield(state, -2, "__newindex");
+    lua_pushcfunction(state, responseLength);
+    lua_setfield(state, -2, "__len");
+    lua_pop(state, 1);
+
+    // One pair of buffers per state is reused by every call
+    auto* request =
+        static_cast<RequestView*>(lua_newuserdata(state, sizeof(RequestView)));
+    *request = RequestView{nullptr, 0};
+    luaL_setmetatable(state, requestMeta);
+    requestRef = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    auto* response = static_cast<ResponseView*>(
+        lua_newuserdata(state, sizeof(ResponseView)));
+    *response = ResponseView{nullptr};
+    luaL_setmetatable(state, responseMeta);
+    responseRef = luaL_ref(state, LUA_REGISTRYINDEX);
+}
+
+LuaEndpointState::~LuaEndpointState()
+{
+    lua_close(state);
+}
+
+int LuaEndpointState::load(const std::string& script, int instructionBudget)
+{
+    // Accepts source as well as luac output
+    int status = luaL_loadfilex(state, script.c_str(), "bt");
+    if (status == LUA_OK)
+    {
+        lua_sethook(state, budgetExceeded, LUA_MASKCOUNT, instructionBudget);
+        status = lua_pcall(state, 0, 1, 0);
+        lua_sethook(state, nullptr, 0, 0);
+    }
+    if (status != LUA_OK)
+    {
+        std::string error = errorMessage(state);
+        lua_pop(state, 1);
+        throw std::runtime_error(error);
+    }
+    if (lua_type(state, -1) != LUA_TFUNCTION)
+    {
+        lua_pop(state, 1);
+        throw std::runtime_error(script + " does not return a function");
+    }
+    return luaL_ref(state, LUA_REGISTRYINDEX);
+}
+
+std::optional<MctpResponse>
+    LuaEndpointState::call(int handler, const std::vector<uint8_t>& request,
+                           int instructionBudget)
+{
+    MctpResponse response;
+
+    lua_rawgeti(state, LUA_REGISTRYINDEX, handler);
+    lua_rawgeti(state, LUA_REGISTRYINDEX, requestRef);
+    auto* requestView = static_cast<RequestView*>(
+        luaL_checkudata(state, -1, requestMeta));
+    *requestView = RequestView{request.data(), request.size()};
+    lua_rawgeti(state, LUA_REGISTRYINDEX, responseRef);
+    auto* responseView = static_cast<ResponseView*>(
+        luaL_checkudata(state, -1, responseMeta));
+    *responseView = ResponseView{&response.payload};
+
+    lua_sethook(state, budgetExceeded, LUA_MASKCOUNT, instructionBudget);
+    int status = lua_pcall(state, 2, 1, 0);
+    lua_sethook(state, nullptr, 0, 0);
+
+    // Scripts may have kept a reference to the buffers
+    *requestView = RequestView{nullptr, 0};
+    *responseView = ResponseView{nullptr};
+
+    if (status != LUA_OK)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            ("mctp-emulator: Lua responder failed: " + errorMessage(state))
+                .c_str());
+        lua_pop(state, 1);
+        return std::nullopt;
+    }
+
+    int isInteger = 0;
+    lua_Integer delay = lua_tointegerx(state, -1, &isInteger);
+    lua_pop(state, 1);
+    if (!isInteger)
+    {
+        // nil, false or anything else: no response
+        return std::nullopt;
+    }
+    response.processingDelay = static_cast<int>(delay);
+    return response;
+}
+
+LuaResponder::LuaResponder(std::shared_ptr<LuaEndpointState> luaState,
+                           std::optional<size_t> commandOffset) :
+    lua(std::move(luaState)),
+    offset(commandOffset)
+{}
+
+void LuaResponder::addScript(std::optional<uint8_t> command,
+                             const std::string& script, int instructionBudget)
+{
+    if (command && !offset)
+    {
+        throw std::runtime_error("message type has no command byte");
+    }
+    Handler handler{lua->load(script, instructionBudget), instructionBudget};
+    if (command)
+    {
+        commands.insert_or_assign(*command, handler);
+    }
+    else
+    {
+        catchAll = handler;
+    }
+}
+
+const LuaResponder::Handler*
+    LuaResponder::find(const std::vector<uint8_t>& request) const
+{
+    if (offset && request.size() > *offset)
+    {
+        auto iter = commands.find(request[*offset]);
+        if (iter != commands.end())
+        {
+            return &iter->second;
+        }
+    }
+    if (catchAll)
+    {
+        return &*catchAll;
+    }
+    return nullptr;
+}
+
+bool LuaResponder::handles(const std::vector<uint8_t>& request) const
+{
+    return find(request) != nullptr;
+}
+
+std::optional<MctpResponse>
+    LuaResponder::respond(const std::vector<uint8_t>& request)
+{
+    const Handler* handler = find(request);
+    if (handler == nullptr)
+    {
+        return std::nullopt;
+    }
+    return lua->call(handler->ref, request, handler->instructionBudget);
+}
+
+std::optional<size_t> LuaResponder::defaultCommandOffset(uint8_t msgType)
+{
+    switch (msgType)
+    {
+        // Message type, Rq/D/instance ID, command code
+        case MCTP_MESSAGE_TYPE_MCTP_CTRL:
+            return 2;
+        // Message type, Rq/D/instance ID, header version/PLDM type, command
+        case MCTP_MESSAGE_TYPE_PLDM:
+            return 3;
+        // Message type, SPDM version, request response code
+        case MCTP_MESSAGE_TYPE_SPDM:
+            return 2;
+        default:
+            return std::nullopt;
+    }
+}
@@ -1,7 +1,26 @@
 #include "MCTPBinding.hpp"
 
+#include "BiosTables.hpp"
+#include "ClientTracker.hpp"
+#include "CxlDevice.hpp"
+#include "DeviceCatalog.hpp"
+#include "NcsiDevice.hpp"
+#include "NvmeDevice.hpp"
+#include "PlantModel.hpp"
+#include "ReqRespTable.hpp"
+#include "TimeSeries.hpp"
+#include "TransportResponders.hpp"
+#include "VendorRegistry.hpp"
+
+#ifdef LUA_RESPONDERS
+#include "LuaResponder.hpp"
+#endif
+
 #include <endian.h>
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <chrono>
@@ -12,13 +31,14 @@
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/bus.hpp>
+#include <thread>
+#include <tuple>
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/MCTP/Base/server.hpp>
 #include <xyz/openbmc_project/MCTP/Endpoint/server.hpp>
 #include <xyz/openbmc_project/MCTP/SupportedMessageTypes/server.hpp>
 
 #include "libmctp-msgtypes.h"
-#include "libmctp-vdpci.h"
 
 using json = nlohmann::json;
 using mctp_base = sdbusplus::xyz::openbmc_project::MCTP::server::Base;
@@ -32,6 +52,7 @@ std::unordered_map<std::string, mctp_base::BindingModeTypes>
         {"endpoint", mctp_base::BindingModeTypes::Endpoint}};
 
 std::string epReqRespFile = "/usr/share/mctp-emulator/req_resp_";
+static ReqRespCache reqRespCache;
 
 std::string hotSwappableDataFile =
     "/usr/share/mctp-emulator/hot_swappable_endpoints.json";
@@ -39,12 +60,11 @@ std::string uuidIntf = "xyz.openbmc_project.Common.UUID";
 
 std::string pciVdMsgIntf = "xyz.openbmc_project.MCTP.PCIVendorDefined";
 std::string mctpDevObj = "/xyz/openbmc_project/mctp/device/";
+std::string powerStateIntf = "xyz.openbmc_project.MCTP.PowerState";
 std::string mctpBaseObj = "/xyz/openbmc_project/mctp";
 
 constexpr const std::string_view addIface = "AdditionalInterfaces";
 
-EndpointInterfaceMap endpointInterface;
-
 static std::string uuid;
 std::string uuidCommonIntf = "xyz.openbmc_project.Common.UUID";
 constexpr sd_id128_t mctpdAppId = SD_ID128_MAKE(29, 1f, 30, a7, 33, dd, 4c, 25,
@@ -55,170 +75,1312 @@ std::shared_ptr<sdbusplus::asio::dbus_interface> mctpInterface;
 std::string mctpIntf = "xyz.openbmc_project.MCTP.Base";
 bool timerExpired = true;
 
+struct PendingResponse
+{
+    int delay;
+    uint8_t msgType;
+    uint8_t srcEid;
+    uint8_t msgTag;
+    bool tagOwner;
+    std::vector<uint8_t> response;
+    // false while the response is still being computed
+    bool ready;
+    uint64_t id;
+    // Unique bus name of the requester
+    std::string sender;
+};
+
 static std::unique_ptr<boost::asio::steady_timer> delayTimer;
-static std::vector<std::pair<
-    int, std::tuple<uint8_t, uint8_t, uint8_t, bool, std::vector<uint8_t>>>>
-    respQueue;
+static std::vector<PendingResponse> respQueue;
+static uint64_t nextResponseId = 0;
+static std::unique_ptr<ClientTracker> clientTracker;
+
+constexpr int retryTimeMilliSec = 10;
+
+// SupportedMessageTypes properties and the config fields backing them
+static const std::array<std::pair<const char*, bool EndpointConfig::*>, 11>
+    msgTypeFields = {{{"MctpControl", &EndpointConfig::mctpControl},
+                      {"PLDM", &EndpointConfig::pldm},
+                      {"NCSI", &EndpointConfig::ncsi},
+                      {"Ethernet", &EndpointConfig::ethernet},
+                      {"NVMeMgmtMsg", &EndpointConfig::nvmeMgmtMsg},
+                      {"SPDM", &EndpointConfig::spdm},
+                      {"SECUREDMSG", &EndpointConfig::securedMsg},
+                      {"VDPCI", &EndpointConfig::vdpci},
+                      {"VDIANA", &EndpointConfig::vdiana},
+                      {"CXLFMAPI", &EndpointConfig::cxlFmApi},
+                      {"CXLCCI", &EndpointConfig::cxlCci}}};
+
+static std::optional<EndpointConfig>
+    parseEndpointConfig(json iter, const std::string& file)
+{
+    EndpointConfig config;
+    try
+    {
+        config.eid = iter["Eid"];
+        config.uuid = iter["Uuid"];
+        config.mode = mctp_base::convertBindingModeTypesToString(
+            stringToBindingModeMap.at(iter["Mode"]));
+        config.networkId = iter["NetworkId"];
+        json msgType = iter["SupportedMessageTypes"];
+        for (const auto& [name, field] : msgTypeFields)
+        {
+            // The CXL types are optional, most configurations predate them
+            if (field == &EndpointConfig::cxlFmApi ||
+                field == &EndpointConfig::cxlCci)
+            {
+                config.*field = msgType.value(name, false);
+                continue;
+            }
+            config.*field = msgType[name];
+        }
+        if (config.vdpci == true)
+        {
+            json vdpcimt = iter["VDPCIMT"];
+            config.vdpciCapabilitySets =
+                vdpcimt.at("CapabilitySets").get<std::vector<uint16_t>>();
+        }
+
+        if (iter.contains("CXLDevice"))
+        {
+            config.cxlDevice = iter["CXLDevice"];
+        }
+
+        if (iter.contains("NCSIDevice"))
+        {
+            config.ncsiDevice = iter["NCSIDevice"];
+        }
+
+        config.ethernetTap = iter.value("EthernetTap", "");
+
+        if (iter.contains("Busy"))
+        {
+            config.busy = iter["Busy"];
+        }
+
+        if (iter.contains("Power"))
+        {
+            config.power = iter["Power"];
+        }
+
+        if (iter.contains("Plant"))
+        {
+            config.plant = iter["Plant"];
+        }
+
+        if (iter.contains("TimeSeries"))
+        {
+            config.timeSeries = iter["TimeSeries"];
+        }
+
+        if (iter.contains("BIOSTables"))
+        {
+            config.biosTables = iter["BIOSTables"];
+        }
+
+        if (iter.contains("NVMeDevice"))
+        {
+            config.nvmeDevice = iter["NVMeDevice"];
+        }
+
+        config.kind = iter.value("Kind", "");
+        config.kindDelay = iter.value("ResponseDelay", 0);
+
+        if (iter.contains("LuaResponders"))
+        {
+            config.luaResponders = iter["LuaResponders"];
+            for (const auto& script : config.luaResponders)
+            {
+                script.at("MessageType").get<uint8_t>();
+                script.at("Script").get<std::string>();
+            }
+        }
+
+        if (iter.contains("Devices"))
+        {
+            config.devices = iter["Devices"];
+            for (const auto& device : config.devices)
+            {
+                device.at("MessageType").get<uint8_t>();
+                device.at("Device").get<std::string>();
+            }
+        }
+
+        if (iter.contains(addIface))
+        {
+            config.additionalInterfaces = iter[std::string(addIface).c_str()];
+            // TODO: Property value could be of any type, deduce the property
+            // type using type() API. uint8_t should suffice for now
+            for (auto& it : config.additionalInterfaces.items())
+            {
+                for (auto& ifaceList : it.value().items())
+                {
+                    for (auto& propertyList : ifaceList.value().items())
+                    {
+                        propertyList.value().get<uint8_t>();
+                    }
+                }
+            }
+        }
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return std::nullopt;
+    }
+    catch (std::out_of_range& e)
+    {
+        std::cerr << "message: " << e.what() << std::endl;
+        return std::nullopt;
+    }
+    config.source = file;
+    return config;
+}
+
+static bool endpointConfigEqual(const EndpointConfig& lhs,
+                                const EndpointConfig& rhs)
+{
+    auto fields = [](const EndpointConfig& c) {
+        return std::tie(c.eid, c.uuid, c.mode, c.networkId, c.mctpControl,
+                        c.pldm, c.ncsi, c.ethernet, c.nvmeMgmtMsg, c.spdm,
+                        c.securedMsg, c.vdpci, c.vdiana, c.cxlFmApi,
+                        c.cxlCci, c.vdpciCapabilitySets,
+                        c.additionalInterfaces, c.luaResponders, c.devices,
+                        c.cxlDevice, c.ncsiDevice, c.ethernetTap, c.busy,
+                        c.power, c.plant, c.timeSeries, c.biosTables,
+                        c.nvmeDevice, c.kind, c.kindDelay);
+    };
+    return fields(lhs) == fields(rhs);
+}
+
+void MctpBinding::createEndpoint(const EndpointConfig& config)
+{
+    std::string mctpEpObj = mctpDevObj + std::to_string(config.eid);
+    std::string vendorID = "0x8086";
+
+    // Interfaces are initialized without the PropertiesChanged burst; clients
+    // get every value from InterfacesAdded already.
+    constexpr bool skipPropertyChangedSignal = true;
+
+    // Additional interfaces are to be populated on the endpoint object
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> extraIntfs;
+    for (auto& it : config.additionalInterfaces.items())
+    {
+        for (auto& ifaceList : it.value().items())
+        {
+            auto epIntf =
+                objectServer->add_interface(mctpEpObj, ifaceList.key());
+
+            for (auto& propertyList : ifaceList.value().items())
+            {
+                std::string propertyName(propertyList.key());
+                uint8_t propertyValue = propertyList.value();
+                epIntf->register_property(propertyName, propertyValue);
+            }
+            epIntf->initialize(skipPropertyChangedSignal);
+            extraIntfs.push_back(epIntf);
+        }
+    }
+    if (!extraIntfs.empty())
+    {
+        additionalInterfaces.emplace(config.eid, std::move(extraIntfs));
+    }
+
+    std::shared_ptr<sdbusplus::asio::dbus_interface> epIntf;
+    std::shared_ptr<sdbusplus::asio::dbus_interface> msgTypeIntf;
+    std::shared_ptr<sdbusplus::asio::dbus_interface> vendorDefMsgIntf;
+    std::shared_ptr<sdbusplus::asio::dbus_interface> uuidEndPointIntf;
+
+    epIntf = objectServer->add_interface(mctpEpObj, mctp_endpoint::interface);
+    epIntf->register_property("Mode", config.mode);
+    epIntf->register_property("NetworkId", config.networkId);
+    epIntf->initialize(skipPropertyChangedSignal);
+    endpointInterfaces.emplace(config.eid, epIntf);
+
+    msgTypeIntf =
+        objectServer->add_interface(mctpEpObj, mctp_msg_types::interface);
+    for (const auto& [name, field] : msgTypeFields)
+    {
+        msgTypeIntf->register_property(name, config.*field);
+    }
+    msgTypeIntf->initialize(skipPropertyChangedSignal);
+    msgInterfaces.emplace(config.eid, msgTypeIntf);
+
+    if (config.vdpci == true)
+    {
+        vendorDefMsgIntf = objectServer->add_interface(mctpEpObj, pciVdMsgIntf);
+        vendorDefMsgIntf->register_property("VendorID", vendorID);
+        vendorDefMsgIntf->register_property("MessageTypeProperty",
+                                            config.vdpciCapabilitySets);
+        vendorDefMsgIntf->initialize(skipPropertyChangedSignal);
+        vendorInterfaces.emplace(config.eid, vendorDefMsgIntf);
+    }
+
+    uuidEndPointIntf = objectServer->add_interface(mctpEpObj, uuidIntf);
+    uuidEndPointIntf->register_property("UUID", config.uuid);
+    uuidEndPointIntf->initialize(skipPropertyChangedSignal);
+    uuidInterfaces.emplace(config.eid, uuidEndPointIntf);
+
+    addEndpointModels(config);
+
+    endpointConfigs.insert_or_assign(config.eid, config);
+    endpointGenerations.insert_or_assign(config.eid, ++topologyGeneration);
+    removedEndpoints.erase(config.eid);
+
+    phosphor::logging::log<phosphor::logging::level::INFO>(
+        ("mctp-emulator: Added Endpoint " + std::to_string(config.eid))
+            .c_str());
+}
+
+void MctpBinding::addEndpointModels(const EndpointConfig& config)
+{
+    addCxlDevice(config);
+    addNcsiDevice(config);
+    addEthernetBridge(config);
+    addBusyModel(config);
+    addPowerModel(config);
+    addPlantModel(config);
+    addTimeSeries(config);
+    addBiosTables(config);
+    addNvmeDevice(config);
+    addTransportKind(config);
+    addLuaResponders(config);
+    addDevices(config);
+}
+
+void MctpBinding::removeEndpointModels(mctp_eid_t dstEid)
+{
+    endpointResponders.erase(dstEid);
+    busyModels.erase(dstEid);
+    anyTypeResponders.erase(dstEid);
+    powerModels.erase(dstEid);
+
+    auto bridge = ethernetBridges.find(dstEid);
+    if (bridge != ethernetBridges.end())
+    {
+        bridge->second->close();
+        ethernetBridges.erase(bridge);
+    }
+}
+
+void MctpBinding::addCxlDevice(const EndpointConfig& config)
+{
+    if (config.cxlDevice.is_null())
+    {
+        return;
+    }
+
+    CxlDeviceResponder::Params params;
+    const json& device = config.cxlDevice;
+    try
+    {
+        params.vendorId = device.value("VendorId", params.vendorId);
+        params.deviceId = device.value("DeviceId", params.deviceId);
+        params.subsystemVendorId =
+            device.value("SubsystemVendorId", params.subsystemVendorId);
+        params.subsystemId = device.value("SubsystemId", params.subsystemId);
+        params.serialNumber =
+            device.value("SerialNumber", uint64_t{config.eid});
+        params.firmwareRevision =
+            device.value("FirmwareRevision", params.firmwareRevision);
+        params.capacity = device.value("Capacity", params.capacity);
+        params.healthStatus =
+            device.value("HealthStatus", params.healthStatus);
+        params.mediaStatus = device.value("MediaStatus", params.mediaStatus);
+        params.lifeUsed = device.value("LifeUsed", params.lifeUsed);
+        params.temperature = device.value("Temperature", params.temperature);
+        params.dirtyShutdownCount =
+            device.value("DirtyShutdownCount", params.dirtyShutdownCount);
+        params.vendorLogSize =
+            device.value("VendorLogSize", params.vendorLogSize);
+        params.processingDelay =
+            device.value("ProcessingDelay", params.processingDelay);
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+
+    auto responder = std::make_shared<CxlDeviceResponder>(params);
+    if (config.cxlFmApi)
+    {
+        addResponder(config.eid, mctpMsgTypeCxlFmApi, responder);
+    }
+    if (config.cxlCci)
+    {
+        addResponder(config.eid, mctpMsgTypeCxlCci, responder);
+    }
+}
+
+void MctpBinding::addNcsiDevice(const EndpointConfig& config)
+{
+    if (config.ncsiDevice.is_null() || !config.ncsi)
+    {
+        return;
+    }
+
+    NcsiDeviceResponder::Params params;
+    const json& device = config.ncsiDevice;
+    try
+    {
+        params.packages = device.value("Packages", params.packages);
+        params.channels = device.value("Channels", params.channels);
+        params.speedDuplex = device.value("SpeedDuplex", params.speedDuplex);
+        params.firmwareName =
+            device.value("FirmwareName", params.firmwareName);
+        params.firmwareVersion =
+            device.value("FirmwareVersion", params.firmwareVersion);
+        params.pciVendorId = device.value("PciVendorId", params.pciVendorId);
+        params.pciDeviceId = device.value("PciDeviceId", params.pciDeviceId);
+        params.manufacturerId =
+            device.value("ManufacturerId", params.manufacturerId);
+        params.rxPacketsPerSec =
+            device.value("RxPacketsPerSec", params.rxPacketsPerSec);
+        params.txPacketsPerSec =
+            device.value("TxPacketsPerSec", params.txPacketsPerSec);
+        params.averagePacketSize =
+            device.value("AveragePacketSize", params.averagePacketSize);
+        params.passThroughPacketsPerSec = device.value(
+            "PassThroughPacketsPerSec", params.passThroughPacketsPerSec);
+        params.errorsPerMillion =
+            device.value("ErrorsPerMillion", params.errorsPerMillion);
+        params.channelLoad = device.value("ChannelLoad", params.channelLoad);
+        params.processingDelay =
+            device.value("ProcessingDelay", params.processingDelay);
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+
+    addResponder(config.eid, MCTP_MESSAGE_TYPE_NCSI,
+                 std::make_shared<NcsiDeviceResponder>(params));
+}
+
+void MctpBinding::addNvmeDevice(const EndpointConfig& config)
+{
+    if (config.nvmeDevice.is_null() || !config.nvmeMgmtMsg)
+    {
+        return;
+    }
+
+    NvmeDeviceResponder::Params params;
+    const json& device = config.nvmeDevice;
+    try
+    {
+        params.pciVendorId = device.value("PciVendorId", params.pciVendorId);
+        params.serialNumber = device.value(
+            "SerialNumber", "MCTPEMU" + std::to_string(config.eid));
+        params.modelNumber = device.value("ModelNumber", params.modelNumber);
+        params.firmwareRevision =
+            device.value("FirmwareRevision", params.firmwareRevision);
+        params.namespaceBlocks =
+            device.value("NamespaceBlocks", params.namespaceBlocks);
+        params.blockSizeShift =
+            device.value("BlockSizeShift", params.blockSizeShift);
+        params.temperature = device.value("Temperature", params.temperature);
+        params.percentageUsed =
+            device.value("PercentageUsed", params.percentageUsed);
+        params.powerOnHours =
+            device.value("PowerOnHours", params.powerOnHours);
+        params.powerCycles = device.value("PowerCycles", params.powerCycles);
+        params.readCommandsPerSec =
+            device.value("ReadCommandsPerSec", params.readCommandsPerSec);
+        params.writeCommandsPerSec =
+            device.value("WriteCommandsPerSec", params.writeCommandsPerSec);
+        params.errorLogEntries =
+            device.value("ErrorLogEntries", params.errorLogEntries);
+        params.telemetryBlocks =
+            device.value("TelemetryBlocks", params.telemetryBlocks);
+        params.processingDelay =
+            device.value("ProcessingDelay", params.processingDelay);
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+
+    addResponder(config.eid, MCTP_MESSAGE_TYPE_NVME,
+                 std::make_shared<NvmeDeviceResponder>(params));
+}
+
+void MctpBinding::addTransportKind(const EndpointConfig& config)
+{
+    if (config.kind.empty())
+    {
+        return;
+    }
+
+    std::shared_ptr<Responder> responder;
+    if (config.kind == "Echo")
+    {
+        responder = std::make_shared<EchoResponder>(config.kindDelay);
+    }
+    else if (config.kind == "Sized")
+    {
+        responder = std::make_shared<SizedResponder>(config.kindDelay);
+    }
+    else if (config.kind == "Integrity")
+    {
+        responder = std::make_shared<IntegrityResponder>(config.kindDelay);
+    }
+    else
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            ("mctp-emulator: Unknown endpoint kind " + config.kind).c_str());
+        return;
+    }
+    anyTypeResponders.insert_or_assign(config.eid, std::move(responder));
+}
+
+void MctpBinding::addBusyModel(const EndpointConfig& config)
+{
+    if (config.busy.is_null())
+    {
+        return;
+    }
+
+    BusyModel::Params params;
+    const json& busy = config.busy;
+    try
+    {
+        params.probability = busy.value("Probability", params.probability);
+        params.maxRequests = busy.value("MaxRequests", params.maxRequests);
+        params.window = std::chrono::milliseconds(
+            busy.value("WindowMs", params.window.count()));
+        params.rdtExponent = busy.value("RDTExponent", params.rdtExponent);
+        params.rdtm = busy.value("RDTM", params.rdtm);
+        params.pldmCompletionCode =
+            busy.value("PLDMCompletionCode", params.pldmCompletionCode);
+        params.notReadyDelay =
+            busy.value("NotReadyDelay", params.notReadyDelay);
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+
+    busyModels.insert_or_assign(config.eid,
+                                std::make_shared<BusyModel>(params));
+}
+
+void MctpBinding::addPowerModel(const EndpointConfig& config)
+{
+    if (config.power.is_null())
+    {
+        removeInterface(config.eid, powerInterfaces);
+        return;
+    }
+
+    PowerModel::Params params;
+    const json& power = config.power;
+    try
+    {
+        params.idleTimeout = std::chrono::milliseconds(
+            power.value("IdleTimeoutMs", params.idleTimeout.count()));
+        params.lowPowerTimeout = std::chrono::milliseconds(
+            power.value("LowPowerTimeoutMs", params.lowPowerTimeout.count()));
+        params.idleWakePenalty = std::chrono::milliseconds(
+            power.value("IdleWakePenaltyMs", params.idleWakePenalty.count()));
+        params.lowPowerWakePenalty = std::chrono::milliseconds(power.value(
+            "LowPowerWakePenaltyMs", params.lowPowerWakePenalty.count()));
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        removeInterface(config.eid, powerInterfaces);
+        return;
+    }
+
+    auto idlePenalty = static_cast<uint64_t>(params.idleWakePenalty.count());
+    auto lowPowerPenalty =
+        static_cast<uint64_t>(params.lowPowerWakePenalty.count());
+    std::shared_ptr<sdbusplus::asio::dbus_interface> powerIntf;
+    auto existing = powerInterfaces.find(config.eid);
+    if (existing != powerInterfaces.end())
+    {
+        // Model rebuilt on an update, the interface stays and only its
+        // properties change
+        powerIntf = existing->second;
+        powerIntf->set_property(
+            "PowerState", PowerModel::toString(PowerModel::State::active));
+        powerIntf->set_property("IdleWakePenaltyMs", idlePenalty);
+        powerIntf->set_property("LowPowerWakePenaltyMs", lowPowerPenalty);
+    }
+    else
+    {
+        std::string mctpEpObj = mctpDevObj + std::to_string(config.eid);
+        powerIntf = objectServer->add_interface(mctpEpObj, powerStateIntf);
+        powerIntf->register_property(
+            "PowerState", PowerModel::toString(PowerModel::State::active));
+        powerIntf->register_property("IdleWakePenaltyMs", idlePenalty);
+        powerIntf->register_property("LowPowerWakePenaltyMs",
+                                     lowPowerPenalty);
+        powerIntf->initialize(true);
+        powerInterfaces.emplace(config.eid, powerIntf);
+    }
+
+    auto model = std::make_shared<PowerModel>(
+        bus->get_io_context(), params, [powerIntf](PowerModel::State state) {
+            powerIntf->set_property("PowerState", PowerModel::toString(state));
+        });
+    model->start();
+    powerModels.insert_or_assign(config.eid, std::move(model));
+}
+
+void MctpBinding::addPlantModel(const EndpointConfig& config)
+{
+    if (config.plant.is_null() || !config.pldm)
+    {
+        return;
+    }
+
+    PlantModel::Params params;
+    int processingDelay = 1;
+    const json& plant = config.plant;
+    try
+    {
+        params.step = std::chrono::milliseconds(
+            plant.value("StepMs", params.step.count()));
+        processingDelay = plant.value("ProcessingDelay", processingDelay);
+        for (const auto& item : plant.value("NumericEffecters", json::array()))
+        {
+            PlantModel::NumericEffecter effecter;
+            effecter.id = item.at("Id");
+            effecter.min = item.value("Min", effecter.min);
+            effecter.max = item.value("Max", effecter.max);
+            effecter.value = item.value("Initial", effecter.min);
+            effecter.resolution = item.value("Resolution", effecter.resolution);
+            params.numericEffecters.push_back(effecter);
+        }
+        for (const auto& item : plant.value("StateEffecters", json::array()))
+        {
+            PlantModel::StateEffecter effecter;
+            effecter.id = item.at("Id");
+            effecter.states = item.value("States", std::vector<uint8_t>{1});
+            params.stateEffecters.push_back(effecter);
+        }
+        for (const auto& item : plant.value("Sensors", json::array()))
+        {
+            PlantModel::Sensor sensor;
+            sensor.id = item.at("Id");
+            sensor.ambient = item.value("Ambient", sensor.ambient);
+            sensor.value = item.value("Initial", sensor.ambient);
+            sensor.timeConstant = std::chrono::milliseconds(item.value(
+                "TimeConstantMs", sensor.timeConstant.count()));
+            sensor.resolution = item.value("Resolution", sensor.resolution);
+            for (const auto& input : item.value("Inputs", json::array()))
+            {
+                sensor.inputs.push_back(
+                    {input.at("Effecter"), input.value("Gain", 0.0)});
+            }
+            params.sensors.push_back(sensor);
+        }
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+
+    auto model = std::make_shared<PlantModel>(bus->get_io_context(), params);
+    model->start();
+    chainResponder(
+        config.eid, MCTP_MESSAGE_TYPE_PLDM,
+        std::make_shared<PldmPlantResponder>(model, processingDelay));
+}
+
+void MctpBinding::addTimeSeries(const EndpointConfig& config)
+{
+    if (config.timeSeries.is_null() || !config.pldm)
+    {
+        return;
+    }
+
+    // PLDM sensor data sizes, in order
+    static const std::array<std::string, 6> dataSizes = {
+        "uint8", "sint8", "uint16", "sint16", "uint32", "sint32"};
+
+    PldmTimeSeriesResponder::Params params;
+    std::shared_ptr<const TimeSeries> series;
+    const json& playback = config.timeSeries;
+    std::string file;
+    try
+    {
+        file = playback.at("File");
+        series = std::make_shared<const TimeSeries>(file);
+        params.end = playback.value("End", "Loop") == "Clamp"
+                         ? TimeSeries::End::clamp
+                         : TimeSeries::End::loop;
+        params.speed = playback.value("Speed", params.speed);
+        params.processingDelay =
+            playback.value("ProcessingDelay", params.processingDelay);
+        for (const auto& item : playback.value("Sensors", json::array()))
+        {
+            PldmTimeSeriesResponder::Sensor sensor;
+            sensor.id = item.at("Id");
+            std::string name = item.at("Column");
+            auto column = series->column(name);
+            std::string dataSize = item.value("DataSize", "sint32");
+            auto size = std::find(dataSizes.begin(), dataSizes.end(), dataSize);
+            if (!column || size == dataSizes.end())
+            {
+                throw std::invalid_argument("no column " + name +
+                                            " or data size " + dataSize);
+            }
+            sensor.column = *column;
+            sensor.dataSize =
+                static_cast<uint8_t>(std::distance(dataSizes.begin(), size));
+            sensor.resolution = item.value("Resolution", sensor.resolution);
+            sensor.offset = item.value("Offset", sensor.offset);
+            params.sensors.push_back(sensor);
+        }
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+    catch (std::exception& e)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            ("mctp-emulator: Unable to play back " + file + ": " + e.what())
+                .c_str());
+        return;
+    }
+
+    chainResponder(
+        config.eid, MCTP_MESSAGE_TYPE_PLDM,
+        std::make_shared<PldmTimeSeriesResponder>(series, params));
+}
+
+void MctpBinding::addBiosTables(const EndpointConfig& config)
+{
+    if (config.biosTables.is_null() || !config.pldm)
+    {
+        return;
+    }
+
+    BiosTableResponder::Params params;
+    const json& bios = config.biosTables;
+    try
+    {
+        params.generatedAttributes =
+            bios.value("GeneratedAttributes", params.generatedAttributes);
+        params.transferSize = bios.value("TransferSize", params.transferSize);
+        params.processingDelay =
+            bios.value("ProcessingDelay", params.processingDelay);
+        for (const auto& item : bios.value("Attributes", json::array()))
+        {
+            using Type = BiosTableResponder::Attribute::Type;
+            BiosTableResponder::Attribute attribute;
+            attribute.name = item.at("Name");
+            std::string type = item.value("Type", "Enumeration");
+            if (type == "Enumeration")
+            {
+                attribute.type = Type::enumeration;
+                attribute.values = item.at("Values");
+                auto value = std::find(attribute.values.begin(),
+                                       attribute.values.end(),
+                                       item.value("Default", ""));
+                attribute.defaultIndex = static_cast<uint8_t>(
+                    value == attribute.values.end()
+                        ? 0
+                        : value - attribute.values.begin());
+            }
+            else if (type == "String")
+            {
+                attribute.type = Type::string;
+                attribute.minLength =
+                    item.value("MinLength", attribute.minLength);
+                attribute.maxLength =
+                    item.value("MaxLength", attribute.maxLength);
+                attribute.defaultString = item.value("Default", "");
+            }
+            else if (type == "Integer")
+            {
+                attribute.type = Type::integer;
+                attribute.lowerBound =
+                    item.value("LowerBound", attribute.lowerBound);
+                attribute.upperBound =
+                    item.value("UpperBound", attribute.upperBound);
+                attribute.scalarIncrement =
+                    item.value("ScalarIncrement", attribute.scalarIncrement);
+                attribute.defaultValue =
+                    item.value("Default", attribute.lowerBound);
+            }
+            else
+            {
+                std::cerr << "unknown BIOS attribute type " << type << "\n";
+                continue;
+            }
+            params.attributes.push_back(std::move(attribute));
+        }
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+
+    chainResponder(config.eid, MCTP_MESSAGE_TYPE_PLDM,
+                   std::make_shared<BiosTableResponder>(params));
+}
+
+int MctpBinding::wakeEndpoint(mctp_eid_t dstEid)
+{
+    auto power = powerModels.find(dstEid);
+    if (power == powerModels.end())
+    {
+        return 0;
+    }
+    return static_cast<int>(power->second->requestArrived().count());
+}
+
+void MctpBinding::addLuaResponders(const EndpointConfig& config)
+{
+    if (config.luaResponders.empty())
+    {
+        return;
+    }
+#ifdef LUA_RESPONDERS
+    constexpr int defaultInstructionBudget = 100000;
+
+    std::shared_ptr<LuaEndpointState> luaState;
+    std::unordered_map<uint8_t, std::shared_ptr<LuaResponder>> responders;
+    for (const auto& entry : config.luaResponders)
+    {
+        uint8_t msgType = entry.at("MessageType");
+        std::string script = entry.at("Script");
+        try
+        {
+            if (!luaState)
+            {
+                luaState = std::make_shared<LuaEndpointState>();
+            }
+            auto& responder = responders[msgType];
+            if (!responder)
+            {
+                std::optional<size_t> offset =
+                    LuaResponder::defaultCommandOffset(msgType);
+                if (entry.contains("CommandOffset"))
+                {
+                    offset = entry["CommandOffset"].get<size_t>();
+                }
+                responder = std::make_shared<LuaResponder>(luaState, offset);
+            }
+            std::optional<uint8_t> command;
+            if (entry.contains("Command"))
+            {
+                command = entry["Command"].get<uint8_t>();
+            }
+            responder->addScript(
+                command, script,
+                entry.value("InstructionBudget", defaultInstructionBudget));
+        }
+        catch (std::exception& e)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                ("mctp-emulator: Unable to load " + script + ": " + e.what())
+                    .c_str());
+        }
+    }
+    for (auto& [msgType, responder] : responders)
+    {
+        addResponder(config.eid, msgType, std::move(responder));
+    }
+#else
+    phosphor::logging::log<phosphor::logging::level::ERR>(
+        ("mctp-emulator: Lua responders of endpoint " +
+         std::to_string(config.eid) + " ignored, built without Lua support")
+            .c_str());
+#endif
+}
+
+void MctpBinding::addDevices(const EndpointConfig& config)
+{
+    for (const auto& entry : config.devices)
+    {
+        uint8_t msgType = entry.at("MessageType");
+        std::string name = entry.at("Device");
+        std::shared_ptr<CoroutineResponder> responder;
+        try
+        {
+            auto device = deviceCatalog.create(
+                name, entry.value("Params", json::object()));
+            if (!device)
+            {
+                phosphor::logging::log<phosphor::logging::level::ERR>(
+                    ("mctp-emulator: Unknown device " + name +
+                     " on endpoint " + std::to_string(config.eid))
+                        .c_str());
+                continue;
+            }
+            responder =
+                std::make_shared<CoroutineResponder>(std::move(*device));
+        }
+        catch (json::exception& e)
+        {
+            std::cerr << "message: " << e.what() << '\n'
+                      << "exception id: " << e.id << std::endl;
+            continue;
+        }
+
+        if (!entry.contains("VendorId"))
+        {
+            chainResponder(config.eid, msgType, std::move(responder));
+            continue;
+        }
+        // Only the requests of one vendor, e.g. "VendorId": "0x1D0F"
+        if (msgType != MCTP_MESSAGE_TYPE_VDPCI &&
+            msgType != MCTP_MESSAGE_TYPE_VDIANA)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                ("mctp-emulator: Device " + name + " on endpoint " +
+                 std::to_string(config.eid) +
+                 " has a VendorId but no vendor defined message type")
+                    .c_str());
+            continue;
+        }
+        uint32_t vendorId = 0;
+        try
+        {
+            vendorId = static_cast<uint32_t>(std::stoul(
+                entry["VendorId"].get<std::string>(), nullptr, 0));
+        }
+        catch (const std::exception& e)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                ("mctp-emulator: Invalid VendorId of device " + name +
+                 " on endpoint " + std::to_string(config.eid) + ": " +
+                 e.what())
+                    .c_str());
+            continue;
+        }
+        addVendorResponder(config.eid,
+                           msgType == MCTP_MESSAGE_TYPE_VDPCI
+                               ? VendorRegistry::Space::pci
+                               : VendorRegistry::Space::iana,
+                           vendorId, std::move(responder));
+    }
+}
+
+void MctpBinding::removeEndpoint(mctp_eid_t dstEid)
+{
+    removeInterface(dstEid, msgInterfaces);
+    removeInterface(dstEid, vendorInterfaces);
+    removeInterface(dstEid, uuidInterfaces);
+    removeInterface(dstEid, endpointInterfaces);
+
+    auto extraIntfs = additionalInterfaces.find(dstEid);
+    if (extraIntfs != additionalInterfaces.end())
+    {
+        for (auto& iface : extraIntfs->second)
+        {
+            objectServer->remove_interface(iface);
+        }
+        additionalInterfaces.erase(extraIntfs);
+    }
+
+    if (endpointConfigs.erase(dstEid) != 0)
+    {
+        endpointGenerations.erase(dstEid);
+        removedEndpoints.insert_or_assign(dstEid, ++topologyGeneration);
+    }
+    removeEndpointModels(dstEid);
+    removeInterface(dstEid, powerInterfaces);
+
+    phosphor::logging::log<phosphor::logging::level::INFO>(
+        ("mctp-emulator: Removed Endpoint " + std::to_string(dstEid)).c_str());
+}
+
+void MctpBinding::updateEndpoint(const EndpointConfig& config)
+{
+    EndpointConfig& current = endpointConfigs.at(config.eid);
+
+    // Changes which add or drop whole interfaces are applied by recreating the
+    // endpoint object. Everything else is patched in place so that only the
+    // changed properties are signalled. dbus_interface::set_property signals
+    // each property on its own, changes are not grouped per interface.
+    if (current.vdpci != config.vdpci ||
+        current.additionalInterfaces != config.additionalInterfaces)
+    {
+        removeEndpoint(config.eid);
+        createEndpoint(config);
+        return;
+    }
+
+    // Responders and models have no interfaces of their own, apart from the
+    // power state which addPowerModel keeps or drops as needed
+    if (current.luaResponders != config.luaResponders ||
+        current.devices != config.devices ||
+        current.cxlDevice != config.cxlDevice ||
+        current.ncsiDevice != config.ncsiDevice ||
+        current.ethernetTap != config.ethernetTap ||
+        current.busy != config.busy || current.power != config.power ||
+        current.plant != config.plant ||
+        current.timeSeries != config.timeSeries ||
+        current.biosTables != config.biosTables ||
+        current.nvmeDevice != config.nvmeDevice ||
+        current.kind != config.kind || current.kindDelay != config.kindDelay)
+    {
+        removeEndpointModels(config.eid);
+        addEndpointModels(config);
+    }
+
+    auto& epIntf = endpointInterfaces.at(config.eid);
+    if (current.mode != config.mode)
+    {
+        epIntf->set_property("Mode", config.mode);
+    }
+    if (current.networkId != config.networkId)
+    {
+        epIntf->set_property("NetworkId", config.networkId);
+    }
+
+    auto& msgTypeIntf = msgInterfaces.at(config.eid);
+    for (const auto& [name, field] : msgTypeFields)
+    {
+        if (current.*field != config.*field)
+        {
+            msgTypeIntf->set_property(name, config.*field);
+        }
+    }
+
+    if (config.vdpci == true &&
+        current.vdpciCapabilitySets != config.vdpciCapabilitySets)
+    {
+        vendorInterfaces.at(config.eid)
+            ->set_property("MessageTypeProperty", config.vdpciCapabilitySets);
+    }
+
+    if (current.uuid != config.uuid)
+    {
+        uuidInterfaces.at(config.eid)->set_property("UUID", config.uuid);
+    }
+
+    current = config;
+    endpointGenerations.insert_or_assign(config.eid, ++topologyGeneration);
+
+    phosphor::logging::log<phosphor::logging::level::INFO>(
+        ("mctp-emulator: Updated Endpoint " + std::to_string(config.eid))
+            .c_str());
+}
+
+void MctpBinding::addEndpoints(std::string file, std::optional<uint8_t> destId)
+{
+    std::ifstream jsonFile(file);
+    if (!jsonFile.good())
+    {
+        std::cerr << "unable to open " << file << "\n";
+    }
+    json endpoints = nullptr;
+    try
+    {
+        endpoints = json::parse(jsonFile, nullptr, false);
+    }
+    catch (json::exception& e)
+    {
+        std::cerr << "Error parsing " << file << "\n"
+                  << "message: " << e.what() << '\n'
+                  << "exception id: " << e.id << std::endl;
+        return;
+    }
+    // Create an interface for each of the endpoints parsed in given json
+    // file
+    auto enpointObjManager =
+        std::make_shared<sdbusplus::server::manager::manager>(
+            *bus, mctpBaseObj.c_str());
+
+    for (auto iter : endpoints["Endpoints"])
+    {
+        // If destId has been provided, add data for just that endpoint.
+        // Otherwise add all endpoints in json file
+        if (iter["Eid"] == destId || !destId.has_value())
+        {
+            auto config = parseEndpointConfig(iter, file);
+            if (!config)
+            {
+                continue;
+            }
+            if (endpointConfigs.find(config->eid) != endpointConfigs.end())
+            {
+                phosphor::logging::log<phosphor::logging::level::INFO>(
+                    ("mctp-emulator: Endpoint " + std::to_string(config->eid) +
+                     " already present")
+                        .c_str());
+                continue;
+            }
+            createEndpoint(*config);
+        }
+    }
+    publishEndpoints();
+}
+
+void MctpBinding::reloadEndpoints(const std::string& file)
+{
+    std::ifstream jsonFile(file);
+    if (!jsonFile.good())
+    {
+        std::cerr << "unable to open " << file << "\n";
+        return;
+    }
+
+    json endpoints = json::parse(jsonFile, nullptr, false);
+    if (endpoints.is_discarded() || !endpoints.contains("Endpoints"))
+    {
+        // Most likely caught mid-write, the next change event retries
+        std::cerr << "Error parsing " << file
+                  << ", keeping current endpoints\n";
+        return;
+    }
+
+    std::unordered_map<mctp_eid_t, EndpointConfig> wanted;
+    for (auto iter : endpoints["Endpoints"])
+    {
+        auto config = parseEndpointConfig(iter, file);
+        if (!config)
+        {
+            std::cerr << "Invalid endpoint in " << file
+                      << ", keeping current endpoints\n";
+            return;
+        }
+        // The first entry of an EID wins, as when the file was first loaded
+        mctp_eid_t dstEid = config->eid;
+        if (!wanted.emplace(dstEid, std::move(*config)).second)
+        {
+            phosphor::logging::log<phosphor::logging::level::INFO>(
+                ("mctp-emulator: Endpoint " + std::to_string(dstEid) +
+                 " already present")
+                    .c_str());
+        }
+    }
+
+    // Only endpoints owned by this file are diffed, hot swapped devices added
+    // through AddDevice are left alone.
+    std::vector<mctp_eid_t> removed;
+    for (const auto& [dstEid, current] : endpointConfigs)
+    {
+        if (current.source == file && wanted.find(dstEid) == wanted.end())
+        {
+            removed.push_back(dstEid);
+        }
+    }
+    for (mctp_eid_t dstEid : removed)
+    {
+        removeEndpoint(dstEid);
+    }
+
+    size_t added = 0;
+    size_t modified = 0;
+    for (const auto& [dstEid, config] : wanted)
+    {
+        auto current = endpointConfigs.find(dstEid);
+        if (current == endpointConfigs.end())
+        {
+            createEndpoint(config);
+            added++;
+        }
+        else if (current->second.source != file)
+        {
+            // Belongs to another file or was hot swapped in, that owner
+            // keeps it
+            continue;
+        }
+        else if (!endpointConfigEqual(current->second, config))
+        {
+            updateEndpoint(config);
+            modified++;
+        }
+    }
+    publishEndpoints();
 
-constexpr int retryTimeMilliSec = 10;
+    phosphor::logging::log<phosphor::logging::level::INFO>(
+        ("mctp-emulator: Reloaded " + file + ": " + std::to_string(added) +
+         " added, " + std::to_string(removed.size()) + " removed, " +
+         std::to_string(modified) + " modified")
+            .c_str());
+}
 
-void MctpBinding::addEndpoints(std::string file, std::optional<uint8_t> destId)
+void MctpBinding::addResponder(mctp_eid_t dstEid, uint8_t msgType,
+                               std::shared_ptr<Responder> responder)
 {
-    std::ifstream jsonFile(file);
-    if (!jsonFile.good())
+    auto& responders = endpointResponders[dstEid];
+    if (responders.contains(msgType))
     {
-        std::cerr << "unable to open " << file << "\n";
+        // e.g. Lua scripts on a PLDM endpoint with a plant model, both stay
+        chainResponder(dstEid, msgType, std::move(responder));
+        return;
     }
-    json endpoints = nullptr;
-    uint8_t dstEid;
-    std::string dstUuid;
-    mctp_base::BindingModeTypes mode;
-    uint16_t networkId;
-    json msgType;
-    bool mctpControl;
-    bool pldm;
-    bool ncsi;
-    bool ethernet;
-    bool nvmeMgmtMsg;
-    bool spdm;
-    bool securedMsg;
-    bool vdpci;
-    bool vdiana;
-    std::string vendorID = "0x8086";
-    std::vector<uint16_t> msgTypeProperty;
-    try
+    responders.emplace(msgType, std::move(responder));
+}
+
+void MctpBinding::chainResponder(mctp_eid_t dstEid, uint8_t msgType,
+                                 std::shared_ptr<Responder> responder)
+{
+    auto& current = endpointResponders[dstEid][msgType];
+    auto chain = std::dynamic_pointer_cast<ResponderChain>(current);
+    if (!chain)
     {
-        endpoints = json::parse(jsonFile, nullptr, false);
+        chain = std::make_shared<ResponderChain>();
+        if (current)
+        {
+            chain->add(std::move(current));
+        }
+        current = chain;
     }
-    catch (json::exception& e)
+    chain->add(std::move(responder));
+}
+
+void MctpBinding::addVendorResponder(mctp_eid_t dstEid,
+                                     VendorRegistry::Space space,
+                                     uint32_t vendorId,
+                                     std::shared_ptr<Responder> responder)
+{
+    uint8_t msgType = space == VendorRegistry::Space::pci
+                          ? MCTP_MESSAGE_TYPE_VDPCI
+                          : MCTP_MESSAGE_TYPE_VDIANA;
+    auto& current = endpointResponders[dstEid][msgType];
+    auto vendorResponder = std::dynamic_pointer_cast<VendorResponder>(current);
+    if (vendorResponder)
     {
-        std::cerr << "Error parsing " << file << "\n"
-                  << "message: " << e.what() << '\n'
-                  << "exception id: " << e.id << std::endl;
+        vendorResponder->add(vendorId, std::move(responder));
         return;
     }
-    // Create an interface for each of the endpoints parsed in given json
-    // file
-    auto enpointObjManager =
-        std::make_shared<sdbusplus::server::manager::manager>(
-            *bus, mctpBaseObj.c_str());
+    // Behind whatever already answers the message type, such as a Lua
+    // script
+    vendorResponder = std::make_shared<VendorResponder>();
+    vendorResponder->add(vendorId, std::move(responder));
+    if (current)
+    {
+        chainResponder(dstEid, msgType, std::move(vendorResponder));
+    }
+    else
+    {
+        current = std::move(vendorResponder);
+    }
+}
 
-    for (auto iter : endpoints["Endpoints"])
+void MctpBinding::setAnalyzerLimits(std::chrono::milliseconds requestTimeout,
+                                    size_t maxOutstanding)
+{
+    requesterAnalyzer->setLimits(requestTimeout, maxOutstanding);
+}
+
+// Wire time of a message in whole milliseconds, as delays are counted in.
+// The part below a millisecond is carried over to the next message instead
+// of being rounded away, so over a run of messages the link takes its
+// modelled time to the microsecond.
+int MctpBinding::linkDelay(size_t bytes, bool endpointInitiated) const
+{
+    if (!linkModel)
     {
-        std::string mctpEpObj;
-        // If destId has been provided, add data for just that endpoint.
-        // Otherwise add all endpoints in json file
-        if (iter["Eid"] == destId || !destId.has_value())
+        return 0;
+    }
+    linkCarry += linkModel->transferTime(bytes, endpointInitiated);
+    auto wireTime = std::chrono::floor<std::chrono::milliseconds>(linkCarry);
+    linkCarry -= wireTime;
+    return static_cast<int>(wireTime.count());
+}
+
+std::tuple<uint64_t, std::vector<EndpointRecord>, std::vector<mctp_eid_t>>
+    MctpBinding::getEndpoints(uint64_t sinceGeneration,
+                              const std::vector<uint16_t>& networkIds,
+                              uint32_t msgTypeMask) const
+{
+    std::vector<EndpointRecord> changed;
+    std::vector<mctp_eid_t> removed;
+
+    for (const auto& [dstEid, config] : endpointConfigs)
+    {
+        auto generation = endpointGenerations.find(dstEid);
+        if (generation != endpointGenerations.end() &&
+            generation->second <= sinceGeneration)
         {
-            try
-            {
-                dstEid = iter["Eid"];
-                mctpEpObj = mctpDevObj + std::to_string(dstEid);
-                dstUuid = iter["Uuid"];
-                mode = stringToBindingModeMap.at(iter["Mode"]);
-                networkId = iter["NetworkId"];
-                msgType = iter["SupportedMessageTypes"];
-                mctpControl = msgType["MctpControl"];
-                pldm = msgType["PLDM"];
-                ncsi = msgType["NCSI"];
-                ethernet = msgType["Ethernet"];
-                nvmeMgmtMsg = msgType["NVMeMgmtMsg"];
-                spdm = msgType["SPDM"];
-                securedMsg = msgType["SECUREDMSG"];
-                vdpci = msgType["VDPCI"];
-                vdiana = msgType["VDIANA"];
-                if (vdpci == true)
-                {
-                    json vdpcimt = iter["VDPCIMT"];
-                    msgTypeProperty = vdpcimt.at("CapabilitySets")
-                                          .get<std::vector<uint16_t>>();
-                }
+            continue;
+        }
 
-                if (iter.contains(addIface))
-                {
-                    // Additional interfaces are to be populated on the endpoint
-                    // object
-                    for (auto& it : iter[std::string(addIface).c_str()].items())
-                    {
-                        for (auto& ifaceList : it.value().items())
-                        {
-                            auto epIntf = objectServer->add_interface(
-                                mctpEpObj, ifaceList.key());
-
-                            for (auto& propertyList : ifaceList.value().items())
-                            {
-                                std::string propertyName(propertyList.key());
-                                // TODO: Property value could be of any type,
-                                // deduce the property type using type() API
-                                // uint8_t should suffice for now
-                                uint8_t propertyValue = propertyList.value();
-                                epIntf->register_property(propertyName,
-                                                          propertyValue);
-                            }
-                            epIntf->initialize();
-                        }
-                    }
-                }
+        uint32_t msgTypes = 0;
+        for (size_t bit = 0; bit < msgTypeFields.size(); bit++)
+        {
+            if (config.*msgTypeFields[bit].second)
+            {
+                msgTypes |= 1U << bit;
             }
-            catch (json::exception& e)
+        }
+
+        bool matches =
+            (msgTypes & msgTypeMask) == msgTypeMask &&
+            (networkIds.empty() ||
+             std::find(networkIds.begin(), networkIds.end(),
+                       config.networkId) != networkIds.end());
+        if (!matches)
+        {
+            // May have matched before this change, let incremental clients
+            // drop it
+            if (sinceGeneration != 0)
             {
-                std::cerr << "message: " << e.what() << '\n'
-                          << "exception id: " << e.id << std::endl;
-                continue;
+                removed.push_back(dstEid);
             }
-            catch (std::out_of_range& e)
+            continue;
+        }
+
+        changed.emplace_back(config.networkId, dstEid, config.mode,
+                             config.uuid, msgTypes,
+                             config.vdpciCapabilitySets);
+    }
+
+    if (sinceGeneration != 0)
+    {
+        for (const auto& [dstEid, generation] : removedEndpoints)
+        {
+            if (generation > sinceGeneration)
             {
-                std::cerr << "message: " << e.what() << std::endl;
-                continue;
+                removed.push_back(dstEid);
             }
-            std::shared_ptr<sdbusplus::asio::dbus_interface> epIntf;
-            std::shared_ptr<sdbusplus::asio::dbus_interface> msgTypeIntf;
-            std::shared_ptr<sdbusplus::asio::dbus_interface> vendorDefMsgIntf;
-            std::shared_ptr<sdbusplus::asio::dbus_interface> uuidEndPointIntf;
-
-            epIntf = objectServer->add_interface(mctpEpObj,
-                                                 mctp_endpoint::interface);
-            epIntf->register_property(
-                "Mode", mctp_base::convertBindingModeTypesToString(mode));
-            epIntf->register_property("NetworkId", networkId);
-            epIntf->initialize();
-            endpointInterface.emplace(dstEid, epIntf);
-
-            msgTypeIntf = objectServer->add_interface(
-                mctpEpObj, mctp_msg_types::interface);
-            msgTypeIntf->register_property("MctpControl", mctpControl);
-            msgTypeIntf->register_property("PLDM", pldm);
-            msgTypeIntf->register_property("NCSI", ncsi);
-            msgTypeIntf->register_property("Ethernet", ethernet);
-            msgTypeIntf->register_property("NVMeMgmtMsg", nvmeMgmtMsg);
-            msgTypeIntf->register_property("SPDM", spdm);
-            msgTypeIntf->register_property("SECUREDMSG", securedMsg);
-            msgTypeIntf->register_property("VDPCI", vdpci);
-            msgTypeIntf->register_property("VDIANA", vdiana);
-            msgTypeIntf->initialize();
-            msgInterfaces.emplace(dstEid, msgTypeIntf);
-
-            if (vdpci == true)
-            {
-                vendorDefMsgIntf =
-                    objectServer->add_interface(mctpEpObj, pciVdMsgIntf);
-                vendorDefMsgIntf->register_property("VendorID", vendorID);
-                vendorDefMsgIntf->register_property("MessageTypeProperty",
-                                                    msgTypeProperty);
-                vendorDefMsgIntf->initialize();
-                vendorInterfaces.emplace(dstEid, vendorDefMsgIntf);
-            }
-
-            uuidEndPointIntf = objectServer->add_interface(mctpEpObj, uuidIntf);
-            uuidEndPointIntf->register_property("UUID", dstUuid);
-            uuidEndPointIntf->initialize();
-            uuidInterfaces.emplace(dstEid, uuidEndPointIntf);
+        }
+    }
 
-            phosphor::logging::log<phosphor::logging::level::INFO>(
-                ("mctp-emulator: Added Endpoint " + std::to_string(dstEid))
-                    .c_str());
+    return {topologyGeneration, std::move(changed), std::move(removed)};
+}
+
+void MctpBinding::publishEndpoints()
+{
+    EndpointMap endpoints;
+    for (const auto& [dstEid, iface] : endpointInterfaces)
+    {
+        EndpointEntry& entry = endpoints[dstEid];
+        entry.interface = iface;
+        auto responders = endpointResponders.find(dstEid);
+        if (responders != endpointResponders.end())
+        {
+            entry.responders = responders->second;
+        }
+        auto busy = busyModels.find(dstEid);
+        if (busy != busyModels.end())
+        {
+            entry.busy = busy->second;
+        }
+        auto anyType = anyTypeResponders.find(dstEid);
+        if (anyType != anyTypeResponders.end())
+        {
+            entry.anyType = anyType->second;
         }
     }
+    endpointRegistry.publish(std::move(endpoints));
 }
 
 void MctpBinding::getSystemAppUuid(void)
@@ -266,6 +1428,41 @@ static void sendMessageReceivedSignal(uint8_t msgType, uint8_t srcEid,
         "Response signal sent");
 }
 
+void MctpBinding::addEthernetBridge(const EndpointConfig& config)
+{
+    if (config.ethernetTap.empty() || !config.ethernet)
+    {
+        return;
+    }
+
+    std::shared_ptr<EthernetBridge> bridge;
+    try
+    {
+        bridge = std::make_shared<EthernetBridge>(
+            bus->get_io_context(), config.ethernetTap, linkModel,
+            [srcEid = config.eid,
+             msgTag = uint8_t{0}](std::vector<uint8_t> frame) mutable {
+                // Frames from the endpoint are requests of their own
+                constexpr bool tagOwner = true;
+                sendMessageReceivedSignal(MCTP_MESSAGE_TYPE_ETHERNET, srcEid,
+                                          msgTag, tagOwner, std::move(frame));
+                msgTag = (msgTag + 1) & 0x07;
+            });
+    }
+    catch (const std::system_error& e)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            ("mctp-emulator: Unable to bridge endpoint " +
+             std::to_string(config.eid) + ": " + e.what())
+                .c_str());
+        return;
+    }
+    bridge->start();
+    ethernetBridges.insert_or_assign(config.eid, bridge);
+    addResponder(config.eid, MCTP_MESSAGE_TYPE_ETHERNET,
+                 std::make_shared<EthernetBridgeResponder>(bridge));
+}
+
 static std::string getMessageType(uint8_t msgType)
 {
     // TODO: Support for OEM message types
@@ -293,6 +1490,12 @@ static std::string getMessageType(uint8_t msgType)
         case MCTP_MESSAGE_TYPE_SECUREDMSG: // 0x06
             msgTypeValue = "SECUREDMSG";
             break;
+        case mctpMsgTypeCxlFmApi: // 0x07
+            msgTypeValue = "CXLFMAPI";
+            break;
+        case mctpMsgTypeCxlCci: // 0x08
+            msgTypeValue = "CXLCCI";
+            break;
         case MCTP_MESSAGE_TYPE_VDPCI: // 0x7E
             msgTypeValue = "VDPCI";
             break;
@@ -305,6 +1508,33 @@ static std::string getMessageType(uint8_t msgType)
     return msgTypeValue;
 }
 
+// Sends every response whose delay has run out. A response that is due but
+// still being computed holds back the later responses of its endpoint, so an
+// endpoint never answers out of order.
+static void sendDueResponses()
+{
+    std::bitset<256> blocked;
+    respQueue.erase(std::remove_if(respQueue.begin(), respQueue.end(),
+                                   [&blocked](auto& resp) {
+                                       if (resp.delay > 0)
+                                       {
+                                           return false;
+                                       }
+                                       if (!resp.ready ||
+                                           blocked.test(resp.srcEid))
+                                       {
+                                           blocked.set(resp.srcEid);
+                                           return false;
+                                       }
+                                       sendMessageReceivedSignal(
+                                           resp.msgType, resp.srcEid,
+                                           resp.msgTag, resp.tagOwner,
+                                           resp.response);
+                                       return true;
+                                   }),
+                    respQueue.end());
+}
+
 void processResponse()
 {
     timerExpired = false;
@@ -324,26 +1554,7 @@ void processResponse()
             return;
         }
 
-        respQueue.erase(
-            std::remove_if(respQueue.begin(), respQueue.end(),
-                           [](auto& resp) {
-                               if (resp.first > 0)
-                               {
-                                   return false;
-                               }
-
-                               uint8_t msgType;
-                               uint8_t srcEid;
-                               uint8_t msgTag;
-                               bool tagOwner;
-                               std::vector<uint8_t> response;
-                               std::tie(msgType, srcEid, msgTag, tagOwner,
-                                        response) = resp.second;
-                               sendMessageReceivedSignal(
-                                   msgType, srcEid, msgTag, tagOwner, response);
-                               return true;
-                           }),
-            respQueue.end());
+        sendDueResponses();
 
         if (respQueue.empty())
         {
@@ -355,41 +1566,56 @@ void processResponse()
         else
         {
             std::for_each(respQueue.begin(), respQueue.end(),
-                          [](auto& resp) { resp.first -= retryTimeMilliSec; });
+                          [](auto& resp) { resp.delay -= retryTimeMilliSec; });
             processResponse();
         }
     });
 }
 
-static std::unordered_map<uint16_t, std::string> vendorMap = {
-    {0x8086, "Intel"},
-};
+// Responses queued for a requester that has left the bus would go nowhere
+static void dropClientResponses(const std::string& sender)
+{
+    auto dropped = std::remove_if(
+        respQueue.begin(), respQueue.end(),
+        [&sender](const auto& resp) { return resp.sender == sender; });
+    if (dropped != respQueue.end())
+    {
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            ("mctp-emulator: Dropped " +
+             std::to_string(std::distance(dropped, respQueue.end())) +
+             " queued responses of " + sender)
+                .c_str());
+        respQueue.erase(dropped, respQueue.end());
+    }
+}
 
-static void createAsyncDelay(boost::asio::yield_context& yield,
+// False when the requester left the bus before the delay ran out
+static bool createAsyncDelay(ClientTracker::Call& call,
+                             boost::asio::yield_context& yield,
                              const uint16_t timeout)
 {
-    boost::asio::steady_timer timer(bus->get_io_context());
-    boost::system::error_code ec;
-
-    timer.expires_after(std::chrono::milliseconds(timeout));
-    timer.async_wait(yield[ec]);
+    return call.wait(std::chrono::milliseconds(timeout), yield);
 }
 
-static bool handleAtomicResponseTimeout(boost::asio::yield_context& yield,
+static bool handleAtomicResponseTimeout(ClientTracker::Call& call,
+                                        boost::asio::yield_context& yield,
                                         const int processingDelay,
                                         const uint16_t timeout)
 {
     uint16_t uProcessingDelay = static_cast<uint16_t>(processingDelay);
 
-    if (uProcessingDelay < timeout && processingDelay > 0)
+    if (processingDelay == 0)
     {
-        createAsyncDelay(yield, uProcessingDelay);
         return true;
     }
+    else if (uProcessingDelay < timeout && processingDelay > 0)
+    {
+        return createAsyncDelay(call, yield, uProcessingDelay);
+    }
 
     else
     {
-        createAsyncDelay(yield, timeout);
+        createAsyncDelay(call, yield, timeout);
         phosphor::logging::log<phosphor::logging::level::WARNING>(
             "mctp-emulator: No response");
         return false;
@@ -399,7 +1625,8 @@ static bool handleAtomicResponseTimeout(boost::asio::yield_context& yield,
 static void createResponseSignal(int processingDelay, const uint8_t srcEid,
                                  const uint8_t msgType, const bool tagOwner,
                                  const uint8_t msgTag,
-                                 std::vector<uint8_t>& response)
+                                 std::vector<uint8_t>& response,
+                                 const std::string& sender)
 {
     if (processingDelay < 0)
     {
@@ -408,16 +1635,23 @@ static void createResponseSignal(int processingDelay, const uint8_t srcEid,
         return;
     }
 
-    else if (processingDelay == 0)
+    // An earlier response of the endpoint that is still being computed, or
+    // is held back behind one, goes out first. Queued, sendDueResponses()
+    // keeps that order.
+    bool behindEarlier = std::any_of(
+        respQueue.begin(), respQueue.end(), [srcEid](const auto& resp) {
+            return resp.srcEid == srcEid && (!resp.ready || resp.delay <= 0);
+        });
+    if (processingDelay == 0 && !behindEarlier)
     {
         sendMessageReceivedSignal(msgType, srcEid, msgTag, tagOwner, response);
     }
 
     else
     {
-        respQueue.push_back(std::make_pair(
-            processingDelay,
-            std::make_tuple(msgType, srcEid, msgTag, tagOwner, response)));
+        respQueue.push_back(PendingResponse{processingDelay, msgType, srcEid,
+                                            msgTag, tagOwner, response, true,
+                                            nextResponseId++, sender});
         if (timerExpired)
         {
             processResponse();
@@ -427,18 +1661,65 @@ static void createResponseSignal(int processingDelay, const uint8_t srcEid,
     }
 }
 
-std::optional<std::pair<int, std::vector<uint8_t>>>
-    processPayload(std::ifstream& jfile, bool validEid,
+// Queues a response whose payload is still being computed, it goes out once
+// completeComputedResponse() has delivered the payload and the delay expired
+static uint64_t queueComputedResponse(int processingDelay, const uint8_t srcEid,
+                                      const uint8_t msgType,
+                                      const bool tagOwner, const uint8_t msgTag,
+                                      const std::string& sender)
+{
+    uint64_t id = nextResponseId++;
+    respQueue.push_back(PendingResponse{processingDelay, msgType, srcEid,
+                                        msgTag, tagOwner, {}, false, id,
+                                        sender});
+    if (timerExpired)
+    {
+        processResponse();
+    }
+    return id;
+}
+
+static void
+    completeComputedResponse(uint64_t id,
+                             std::optional<std::vector<uint8_t>> response,
+                             int extraDelay)
+{
+    auto resp =
+        std::find_if(respQueue.begin(), respQueue.end(),
+                     [id](const auto& entry) { return entry.id == id; });
+    if (resp == respQueue.end())
+    {
+        return;
+    }
+
+    if (!response.has_value())
+    {
+        respQueue.erase(resp);
+        phosphor::logging::log<phosphor::logging::level::INFO>(
+            "mctp-emulator: No response from responder");
+        return;
+    }
+
+    resp->response = std::move(*response);
+    resp->ready = true;
+    resp->delay += extraDelay;
+    if (resp->delay <= 0)
+    {
+        // Computation overran the processing delay, don't wait for a tick
+        sendDueResponses();
+    }
+}
+
+std::optional<MctpResponse>
+    processPayload(const ReqRespFile& reqResp, bool validEid,
                    const std::vector<uint8_t>& payload)
 {
     phosphor::logging::log<phosphor::logging::level::INFO>(
         "processPayload called...");
     std::string messageType;
     uint8_t msgType;
-    json reqResp = nullptr;
-    json reqRespData = nullptr;
+    std::vector<std::string> tablePath;
 
-    reqResp = json::parse(jfile, nullptr, false);
     // process the MCTP command only oif the above validation are successful
     if (validEid)
     {
@@ -446,7 +1727,7 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
         try
         {
             messageType = getMessageType(msgType);
-            reqRespData = reqResp[messageType];
+            tablePath.push_back(messageType);
         }
         catch (json::exception& e)
         {
@@ -455,51 +1736,34 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
             return std::nullopt;
         }
 
-        std::vector<uint8_t> reqHeader;
-        if (messageType == "VDPCI")
+        const VendorRegistry::Vendor* vendor = nullptr;
+        if (messageType == "VDPCI" || messageType == "VDIANA")
         {
-            if (payload.size() < sizeof(mctp_vdpci_intel_hdr))
-            {
-                phosphor::logging::log<phosphor::logging::level::WARNING>(
-                    "mctp-emulator: Invalid VDPCI message: Insufficient bytes "
-                    "in "
-                    "Payload");
-                return std::nullopt;
-            }
-
-            const auto* vdpciMessage =
-                reinterpret_cast<const mctp_vdpci_intel_hdr*>(payload.data());
-            auto vendorIter =
-                vendorMap.find(be16toh(vdpciMessage->vdpci_hdr.vendor_id));
-            if (vendorIter == vendorMap.end())
-            {
-                phosphor::logging::log<phosphor::logging::level::WARNING>(
-                    "mctp-emulator: Invalid VDPCI message: Unknown Vendor ID");
-                return std::nullopt;
-            }
+            vendor = vendorRegistry.identify(payload);
+        }
+        if (messageType == "VDPCI" && vendor == nullptr)
+        {
+            phosphor::logging::log<phosphor::logging::level::WARNING>(
+                "mctp-emulator: Invalid VDPCI message: Unknown Vendor ID");
+            return std::nullopt;
+        }
 
-            const auto& vendorString = vendorIter->second;
-            if (vendorString == "Intel" && vdpciMessage->reserved != 0x80)
+        std::vector<uint8_t> reqHeader;
+        if (vendor != nullptr)
+        {
+            auto header = vendor->parser(payload);
+            if (!header)
             {
-                phosphor::logging::log<phosphor::logging::level::WARNING>(
-                    "mctp-emulator: Invalid VDPCI message: Unexpected value in "
-                    "reserved byte");
                 return std::nullopt;
             }
-            try
+            tablePath.push_back(vendor->name);
+            if (!header->tableKey.empty())
             {
-                auto vendorTypeCode =
-                    std::to_string(vdpciMessage->vendor_type_code);
-                reqRespData = reqRespData[vendorString][vendorTypeCode];
-            }
-            catch (json::exception& e)
-            {
-                std::cerr << "message: " << e.what() << '\n'
-                          << "exception id: " << e.id << std::endl;
-                return std::nullopt;
+                tablePath.push_back(header->tableKey);
             }
             reqHeader.insert(reqHeader.end(), payload.begin(),
-                             payload.begin() + sizeof(mctp_vdpci_intel_hdr));
+                             payload.begin() +
+                                 static_cast<std::ptrdiff_t>(header->size));
         }
         else if (messageType == "PLDM")
         {
@@ -540,66 +1804,39 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
             reqHeader.push_back(msgType);
         }
 
-        for (auto iter : reqRespData)
+        // The header bytes are copied from the payload, only the rest of it
+        // is matched against the table
+        const CompiledTable* table = reqResp.table(tablePath);
+        const CompiledTable::Entry* entry = nullptr;
+        if (table != nullptr && payload.size() >= reqHeader.size())
+        {
+            entry = table->find(payload.data() + reqHeader.size(),
+                                payload.size() - reqHeader.size());
+        }
+        if (entry != nullptr)
         {
+            std::vector<uint8_t> response = {};
             phosphor::logging::log<phosphor::logging::level::INFO>(
-                "mctp-emulator: Parsing commands..");
+                "mctp-emulator: Request Matched");
 
-            std::vector<uint8_t> req = {};
-            try
+            // Fill the response header as per the MCTP message type
+            // Note:- PLDM requests and responses in the JSON
+            // file should starts from second byte of message
+            // header(HdrVer | PLDMType )
+            if (messageType == "PLDM")
             {
-                req.assign(std::begin(iter["request"]),
-                           std::end(iter["request"]));
+                constexpr uint8_t makeResp = 0x7F;
+                response.assign(reqHeader.begin(), reqHeader.end());
+                response.at(1) = response.at(1) & makeResp;
             }
-            catch (json::exception& e)
+            if (messageType == "SECUREDMSG")
             {
-                std::cerr << "message: " << e.what() << '\n'
-                          << "exception id: " << e.id << std::endl;
-                continue;
+                response.assign(reqHeader.begin(), reqHeader.end());
             }
+            response.insert(response.end(), entry->response.begin(),
+                            entry->response.end());
 
-            req.insert(req.begin(), reqHeader.begin(), reqHeader.end());
-            if (req == payload)
-            {
-                int processingDelayMilliSec = 0;
-                std::vector<uint8_t> response = {};
-                phosphor::logging::log<phosphor::logging::level::INFO>(
-                    "mctp-emulator: Request Matched");
-                try
-                {
-                    if (iter.contains("processing-delay"))
-                    {
-                        processingDelayMilliSec = iter["processing-delay"];
-                    }
-
-                    // Fill the response header as per the MCTP message type
-                    // Note:- PLDM requests and responses in the JSON
-                    // file should starts from second byte of message
-                    // header(HdrVer | PLDMType )
-                    if (messageType == "PLDM")
-                    {
-                        constexpr uint8_t makeResp = 0x7F;
-                        response.assign(reqHeader.begin(), reqHeader.end());
-                        response.at(1) = response.at(1) & makeResp;
-                    }
-                    if (messageType == "SECUREDMSG")
-                    {
-                        response.assign(reqHeader.begin(), reqHeader.end());
-                    }
-                    response.insert(response.end(),
-                                    std::begin(iter["response"]),
-                                    std::end(iter["response"]));
-                }
-
-                catch (json::exception& e)
-                {
-                    std::cerr << "message: " << e.what() << '\n'
-                              << "exception id: " << e.id << std::endl;
-                    continue;
-                }
-
-                return std::make_pair(processingDelayMilliSec, response);
-            }
+            return MctpResponse{entry->processingDelay, response, nullptr};
         }
     }
     phosphor::logging::log<phosphor::logging::level::INFO>(
@@ -607,8 +1844,8 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
     return std::nullopt;
 }
 
-std::optional<std::pair<int, std::vector<uint8_t>>>
-    processMctpCommand(uint8_t dstEid, const std::vector<uint8_t> payload)
+std::optional<MctpResponse>
+    processMctpCommand(uint8_t dstEid, std::vector<uint8_t> payload)
 {
     phosphor::logging::log<phosphor::logging::level::INFO>(
         "processMctpCommand called...");
@@ -622,17 +1859,52 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
         return std::nullopt;
     }
 
-    if (endpointInterface.find(dstEid) == endpointInterface.end())
+    std::shared_ptr<Responder> responder;
     {
-        phosphor::logging::log<phosphor::logging::level::INFO>(
-            "mctp-emulator: No EID match found hence no processPayload");
-        return std::nullopt;
+        auto endpoints = endpointRegistry.read();
+        auto endpoint = endpoints->find(dstEid);
+        if (endpoint == endpoints->end())
+        {
+            phosphor::logging::log<phosphor::logging::level::INFO>(
+                "mctp-emulator: No EID match found hence no processPayload");
+            return std::nullopt;
+        }
+        if (endpoint->second.busy)
+        {
+            auto verdict = endpoint->second.busy->intercept(payload);
+            if (verdict.notReady)
+            {
+                return verdict.notReady;
+            }
+            if (verdict.replay)
+            {
+                // RESPOND_IF_READY is answered like the deferred request
+                payload = std::move(*verdict.replay);
+            }
+        }
+        if (endpoint->second.anyType)
+        {
+            responder = endpoint->second.anyType;
+        }
+        else if (!payload.empty())
+        {
+            // Bit 7 of the message type is the integrity check flag
+            auto iter = endpoint->second.responders.find(
+                static_cast<uint8_t>(payload.front() & 0x7F));
+            if (iter != endpoint->second.responders.end() &&
+                iter->second->handles(payload))
+            {
+                responder = iter->second;
+            }
+        }
     }
 
     try
     {
-        std::ifstream jsonFile;
-        jsonFile.exceptions(std::ios::failbit | std::ios::badbit);
+        if (responder)
+        {
+            return responder->respond(payload);
+        }
 
         // the EID concatenated should match the EID's in endpoint.json
         // the resulting named file should be already present as req_resp_x
@@ -641,14 +1913,13 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
         phosphor::logging::log<phosphor::logging::level::INFO>(
             ("Req_Resp_x filename: " + filename).c_str());
 
-        jsonFile.open(filename, std::ios::in);
-        if (!jsonFile.good())
+        auto reqResp = reqRespCache.get(filename);
+        if (!reqResp)
         {
-            std::cerr << "unable to open " << filename << "\n";
             return std::nullopt;
         }
 
-        return processPayload(jsonFile, true, payload);
+        return processPayload(*reqResp, true, payload);
     }
     catch (const std::ifstream::failure& e)
     {
@@ -665,17 +1936,46 @@ std::optional<std::pair<int, std::vector<uint8_t>>>
 
 MctpBinding::MctpBinding(
     std::shared_ptr<sdbusplus::asio::object_server>& objServer,
-    std::string& objPath) :
+    std::string& objPath, unsigned workerThreads, unsigned computeThreads) :
     objectServer(objServer)
 {
     eid = 8;
 
+    if (workerThreads == 0)
+    {
+        workerThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    // Workers read the endpoint registry, which has a slot per reader thread.
+    // One is left for the D-Bus thread.
+    constexpr unsigned maxWorkerThreads =
+        EndpointRegistry::maxReaderThreads - 1;
+    if (workerThreads > maxWorkerThreads)
+    {
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            ("mctp-emulator: Limiting worker threads from " +
+             std::to_string(workerThreads) + " to " +
+             std::to_string(maxWorkerThreads))
+                .c_str());
+        workerThreads = maxWorkerThreads;
+    }
+    requestEngine =
+        std::make_unique<RequestEngine>(bus->get_io_context(), workerThreads);
+    if (computeThreads == 0)
+    {
+        computeThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    computePool =
+        std::make_unique<ComputePool>(bus->get_io_context(), computeThreads);
+    requesterAnalyzer =
+        std::make_unique<RequesterAnalyzer>(bus->get_io_context());
+
     uint8_t bindingType = 0xFF; // OEM Binding
     uint8_t bindingMedium = 0XFF;
     bool staticEidSupport = false;
     std::string bindingMode("xyz.openbmc_project.MCTP.BusOwner");
     delayTimer =
         std::make_unique<boost::asio::steady_timer>(bus->get_io_context());
+    clientTracker = std::make_unique<ClientTracker>(*bus, dropClientResponses);
 
     mctpInterface = objServer->add_interface(objPath, mctpIntf.c_str());
 
@@ -708,11 +2008,8 @@ MctpBinding::MctpBinding(
             mctp_eid_t endpoint_id = endpoint["Eid"];
             if (endpoint_id == destId)
             {
-                removeInterface(endpoint_id, msgInterfaces);
-                removeInterface(endpoint_id, vendorInterfaces);
-                removeInterface(endpoint_id, uuidInterfaces);
-                removeInterface(endpoint_id, endpointInterface);
-
+                removeEndpoint(endpoint_id);
+                publishEndpoints();
                 return;
             }
         }
@@ -724,24 +2021,80 @@ MctpBinding::MctpBinding(
 
     mctpInterface->register_method(
         "SendMctpMessagePayload",
-        [](uint8_t dstEid, uint8_t msgTag, bool tagOwner,
-           std::vector<uint8_t> payload) {
+        [this](boost::asio::yield_context yield,
+               sdbusplus::message::message& msg, uint8_t dstEid,
+               uint8_t msgTag, bool tagOwner, std::vector<uint8_t> payload) {
             int rc = -1;
 
             phosphor::logging::log<phosphor::logging::level::INFO>(
                 "mctp-emulator: Received Payload");
 
-            auto responsePair = processMctpCommand(dstEid, payload);
+            std::string sender = msg.get_sender();
+            ClientTracker::Call call(*clientTracker, sender);
+            // Bridged Ethernet frames are one way, nobody waits for them to
+            // be answered
+            std::optional<RequesterAnalyzer::RequestHandle> request;
+            if (payload.empty() || payload[0] != MCTP_MESSAGE_TYPE_ETHERNET)
+            {
+                request =
+                    requesterAnalyzer->requestStarted(sender, dstEid, payload);
+            }
+            int wakePenalty = wakeEndpoint(dstEid);
+
+            auto mctpResponse = requestEngine->process(
+                dstEid,
+                [dstEid, &payload]() {
+                    return processMctpCommand(dstEid, payload);
+                },
+                yield);
 
-            if (responsePair.has_value())
+            if (mctpResponse.has_value() && call.active())
             {
                 rc = 0;
 
-                int processingDelay = std::get<0>(*responsePair);
-                std::vector<uint8_t> response = std::get<1>(*responsePair);
+                if (mctpResponse->processingDelay >= 0)
+                {
+                    // Request and response both cross the link. The size
+                    // of a computed response is only known once it is done.
+                    mctpResponse->processingDelay +=
+                        wakePenalty + linkDelay(payload.size(), false);
+                    if (!mctpResponse->compute)
+                    {
+                        mctpResponse->processingDelay +=
+                            linkDelay(mctpResponse->payload.size(), true);
+                    }
+
+                    if (request)
+                    {
+                        requesterAnalyzer->responseScheduled(
+                            *request, std::chrono::milliseconds(
+                                          mctpResponse->processingDelay));
+                    }
+                }
 
-                createResponseSignal(processingDelay, dstEid, payload.at(0),
-                                     !tagOwner, msgTag, response);
+                if (mctpResponse->compute &&
+                    mctpResponse->processingDelay >= 0)
+                {
+                    uint64_t id = queueComputedResponse(
+                        mctpResponse->processingDelay, dstEid, payload.at(0),
+                        !tagOwner, msgTag, sender);
+                    computePool->run(
+                        std::move(mctpResponse->compute),
+                        [this,
+                         id](std::optional<std::vector<uint8_t>> response) {
+                            int wireTime =
+                                response ? linkDelay(response->size(), true)
+                                         : 0;
+                            completeComputedResponse(id, std::move(response),
+                                                     wireTime);
+                        });
+                }
+                else
+                {
+                    createResponseSignal(mctpResponse->processingDelay, dstEid,
+                                         payload.at(0), !tagOwner, msgTag,
+                                         mctpResponse->payload, sender);
+                }
             }
 
             return rc;
@@ -749,22 +2102,95 @@ MctpBinding::MctpBinding(
 
     mctpInterface->register_method(
         "SendReceiveMctpMessagePayload",
-        [](boost::asio::yield_context yield, uint8_t dstEid,
-           std::vector<uint8_t> payload, uint16_t timeout) {
+        [this](boost::asio::yield_context yield,
+               sdbusplus::message::message& msg, uint8_t dstEid,
+               std::vector<uint8_t> payload, uint16_t timeout) {
             phosphor::logging::log<phosphor::logging::level::INFO>(
                 "mctp-emulator: Received Payload");
 
-            auto responsePair = processMctpCommand(dstEid, payload);
+            std::string sender = msg.get_sender();
+            ClientTracker::Call call(*clientTracker, sender);
+            auto request = requesterAnalyzer->requestStarted(
+                sender, dstEid, payload, std::chrono::milliseconds(timeout));
+            int wakePenalty = wakeEndpoint(dstEid);
 
-            if (responsePair.has_value())
+            auto mctpResponse = requestEngine->process(
+                dstEid,
+                [dstEid, &payload]() {
+                    return processMctpCommand(dstEid, payload);
+                },
+                yield);
+
+            if (!call.active())
+            {
+                // Nobody is waiting for the reply anymore
+                throw sdbusplus::xyz::openbmc_project::Common::Error::
+                    Timeout();
+            }
+
+            if (mctpResponse.has_value())
             {
-                int processingDelay = std::get<0>(*responsePair);
-                std::vector<uint8_t> response = std::get<1>(*responsePair);
+                int processingDelay = mctpResponse->processingDelay;
+                if (processingDelay >= 0)
+                {
+                    processingDelay +=
+                        wakePenalty + linkDelay(payload.size(), false);
+                    if (!mctpResponse->compute)
+                    {
+                        processingDelay +=
+                            linkDelay(mctpResponse->payload.size(), true);
+                    }
+                }
+
+                if (processingDelay >= 0 && processingDelay < timeout)
+                {
+                    requesterAnalyzer->responseScheduled(
+                        request, std::chrono::milliseconds(processingDelay));
+                }
+
+                // Deferred responses are always computed before anything is
+                // returned, also when there is no delay to overlap with
+                if (mctpResponse->compute && processingDelay >= 0)
+                {
+                    // The processing delay runs while the response is
+                    // computed, only what is left of it is waited out below
+                    auto start = std::chrono::steady_clock::now();
+                    auto response = computePool->run(
+                        std::move(mctpResponse->compute), yield);
+                    auto elapsed = static_cast<int>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+
+                    if (!response.has_value() || elapsed >= timeout ||
+                        !call.active())
+                    {
+                        if (elapsed < timeout)
+                        {
+                            createAsyncDelay(call, yield,
+                                             static_cast<uint16_t>(
+                                                 timeout - elapsed));
+                        }
+                        phosphor::logging::log<phosphor::logging::level::INFO>(
+                            "mctp-emulator: Unable to respond within timeout");
+                        throw sdbusplus::xyz::openbmc_project::Common::Error::
+                            Timeout();
+                    }
+
+                    mctpResponse->payload = std::move(*response);
+                    processingDelay +=
+                        linkDelay(mctpResponse->payload.size(), true) - elapsed;
+                    timeout = static_cast<uint16_t>(timeout - elapsed);
+                    if (processingDelay <= 0)
+                    {
+                        return mctpResponse->payload;
+                    }
+                }
 
-                if (handleAtomicResponseTimeout(yield, processingDelay,
+                if (handleAtomicResponseTimeout(call, yield, processingDelay,
                                                 timeout))
                 {
-                    return response;
+                    return mctpResponse->payload;
                 }
                 else
                 {
@@ -777,13 +2203,30 @@ MctpBinding::MctpBinding(
 
             else
             {
-                createAsyncDelay(yield, timeout);
+                createAsyncDelay(call, yield, timeout);
                 phosphor::logging::log<phosphor::logging::level::INFO>(
                     "mctp-emulator: Error in request");
                 throw sdbusplus::xyz::openbmc_project::Common::Error::Timeout();
             }
         });
 
+    // sender, requests, PLDM instance ID reuses, early retries and
+    // over-subscribed requests per D-Bus client
+    mctpInterface->register_method("GetRequesterStats", [this]() {
+        return requesterAnalyzer->getStats();
+    });
+
+    // Packed endpoint list for discovery clients, see getEndpoints
+    mctpInterface->register_method(
+        "GetEndpoints",
+        [this](uint64_t sinceGeneration, std::vector<uint16_t> networkIds,
+               uint32_t msgTypeMask) {
+            return getEndpoints(sinceGeneration, networkIds, msgTypeMask);
+        });
+
+    mctpInterface->register_method(
+        "ResetRequesterStats", [this]() { requesterAnalyzer->resetStats(); });
+
     mctpInterface->register_signal<uint8_t, uint8_t, uint8_t, bool,
                                    std::vector<uint8_t>>(
         "MessageReceivedSignal");
@@ -825,8 +2268,16 @@ MctpBinding::~MctpBinding()
     {
         objectServer->remove_interface(iface);
     }
-    for (auto& [ep, iface] : endpointInterface)
+    for (auto& [ep, iface] : endpointInterfaces)
     {
         objectServer->remove_interface(iface);
     }
+    endpointRegistry.publish({});
+    for (auto& [ep, ifaces] : additionalInterfaces)
+    {
+        for (auto& iface : ifaces)
+        {
+            objectServer->remove_interface(iface);
+        }
+    }
 }
@@ -0,0 +1,303 @@
+#include "NcsiDevice.hpp"
+
+#include <algorithm>
+#include <array>
+
+// Control packet header following the MCTP message type byte
+constexpr size_t ncsiHeaderSize = 16;
+constexpr uint8_t ncsiHeaderRevision = 0x01;
+constexpr uint8_t ncsiResponseBit = 0x80;
+
+// Response and reason codes
+constexpr uint16_t ncsiCompleted = 0x0000;
+constexpr uint16_t ncsiFailed = 0x0001;
+constexpr uint16_t ncsiUnsupported = 0x0003;
+constexpr uint16_t ncsiNoReason = 0x0000;
+constexpr uint16_t ncsiInvalidPayloadLength = 0x0005;
+constexpr uint16_t ncsiUnknownCommand = 0x7FFF;
+
+// Command types
+constexpr uint8_t ncsiGetLinkStatus = 0x0A;
+constexpr uint8_t ncsiGetVersionId = 0x15;
+constexpr uint8_t ncsiGetCapabilities = 0x16;
+constexpr uint8_t ncsiGetControllerStatistics = 0x18;
+constexpr uint8_t ncsiGetNcsiStatistics = 0x19;
+constexpr uint8_t ncsiGetPassThroughStatistics = 0x1A;
+constexpr uint8_t ncsiOem = 0x50;
+
+// Share of received traffic that is unicast, multicast and broadcast
+constexpr double unicastShare = 0.90;
+constexpr double multicastShare = 0.08;
+constexpr double broadcastShare = 0.02;
+
+static void appendBe(std::vector<uint8_t>& out, uint64_t value, size_t size)
+{
+    for (size_t i = size; i > 0; i--)
+    {
+        out.push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+    }
+}
+
+// Two's complement of the sum of the big endian 16 bit words
+static uint32_t ncsiChecksum(const uint8_t* data, size_t size)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < size; i += 2)
+    {
+        sum += static_cast<uint32_t>(data[i] << 8 | data[i + 1]);
+    }
+    if (size % 2)
+    {
+        sum += static_cast<uint32_t>(data[size - 1] << 8);
+    }
+    return ~sum + 1;
+}
+
+// Frame size histogram bucket of a packet size: 64, 65-127, 128-255,
+// 256-511, 512-1023, 1024-1522, 1523-9022
+static size_t sizeBucket(uint32_t size)
+{
+    constexpr std::array<uint32_t, 6> limits = {64, 127, 255, 511, 1023, 1522};
+    return static_cast<size_t>(
+        std::lower_bound(limits.begin(), limits.end(), size) - limits.begin());
+}
+
+NcsiDeviceResponder::NcsiDeviceResponder(const Params& deviceParams) :
+    params(deviceParams), start(std::chrono::steady_clock::now()),
+    channelStats(static_cast<size_t>(params.packages) * params.channels)
+{
+    for (size_t i = 0; i < channelStats.size(); i++)
+    {
+        channelStats[i].load = i < params.channelLoad.size()
+                                   ? params.channelLoad[i]
+                                   : 1 - static_cast<double>(i % 4) / 8;
+    }
+}
+
+double NcsiDeviceResponder::uptime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+void NcsiDeviceResponder::controllerStatistics(const ChannelStats& stats,
+                                               std::vector<uint8_t>& out) const
+{
+    double seconds = uptime() * stats.load;
+    auto rxPackets = static_cast<uint64_t>(params.rxPacketsPerSec * seconds);
+    auto txPackets = static_cast<uint64_t>(params.txPacketsPerSec * seconds);
+    auto share = [](uint64_t packets, double fraction) {
+        return static_cast<uint64_t>(static_cast<double>(packets) * fraction);
+    };
+    uint64_t rxErrors = rxPackets * params.errorsPerMillion / 1000000;
+
+    // Counters cleared from last read, none
+    appendBe(out, 0, 4);
+    appendBe(out, 0, 4);
+    appendBe(out, rxPackets * params.averagePacketSize, 8);
+    appendBe(out, txPackets * params.averagePacketSize, 8);
+    appendBe(out, share(rxPackets, unicastShare), 8);
+    appendBe(out, share(rxPackets, multicastShare), 8);
+    appendBe(out, share(rxPackets, broadcastShare), 8);
+    appendBe(out, share(txPackets, unicastShare), 8);
+    appendBe(out, share(txPackets, multicastShare), 8);
+    appendBe(out, share(txPackets, broadcastShare), 8);
+    // FCS and alignment errors, false carrier, runt and jabber packets
+    appendBe(out, rxErrors, 4);
+    appendBe(out, rxErrors / 4, 4);
+    appendBe(out, 0, 4);
+    appendBe(out, rxErrors / 8, 4);
+    appendBe(out, rxErrors / 16, 4);
+    // Pause frames, collisions and control frames
+    for (int counter = 0; counter < 9; counter++)
+    {
+        appendBe(out, 0, 4);
+    }
+    // Frame size histograms, received then transmitted
+    size_t bucket = sizeBucket(params.averagePacketSize);
+    for (uint64_t packets : {rxPackets, txPackets})
+    {
+        for (size_t size = 0; size < 7; size++)
+        {
+            appendBe(out, size == bucket ? packets : 0, 4);
+        }
+    }
+    // Valid bytes received, error runt and jabber packets
+    appendBe(out, (rxPackets - rxErrors) * params.averagePacketSize, 8);
+    appendBe(out, rxErrors / 8, 4);
+    appendBe(out, rxErrors / 16, 4);
+}
+
+void NcsiDeviceResponder::passThroughStatistics(const ChannelStats& stats,
+                                                std::vector<uint8_t>& out) const
+{
+    auto packets = static_cast<uint64_t>(params.passThroughPacketsPerSec *
+                                         uptime() * stats.load);
+
+    // Packets from the management controller to the LAN, then drops, channel
+    // state, undersized and oversized errors
+    appendBe(out, packets, 8);
+    for (int counter = 0; counter < 4; counter++)
+    {
+        appendBe(out, 0, 4);
+    }
+    // Packets from the LAN to the management controller and the same errors
+    appendBe(out, packets, 4);
+    for (int counter = 0; counter < 4; counter++)
+    {
+        appendBe(out, 0, 4);
+    }
+}
+
+std::optional<MctpResponse>
+    NcsiDeviceResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (request.size() < 1 + ncsiHeaderSize ||
+        request[2] != ncsiHeaderRevision ||
+        (request[5] & ncsiResponseBit) != 0)
+    {
+        return std::nullopt;
+    }
+
+    uint8_t iid = request[4];
+    uint8_t command = request[5];
+    uint8_t channelId = request[6];
+    size_t package = channelId >> 5;
+    size_t channel = channelId & 0x1F;
+    // Commands for a package or channel that doesn't exist go unanswered
+    if (package >= params.packages ||
+        (channel != 0x1F && channel >= params.channels))
+    {
+        return std::nullopt;
+    }
+    ChannelStats& stats =
+        channelStats[package * params.channels +
+                     (channel == 0x1F ? 0 : channel)];
+    stats.packetsReceived++;
+
+    size_t payloadLength = (request[7] & 0x0F) << 8 | request[8];
+    size_t padded = (payloadLength + 3) & ~size_t{3};
+    const uint8_t* packet = &request[1];
+    if (request.size() >= 1 + ncsiHeaderSize + padded + 4)
+    {
+        const uint8_t* checksum = packet + ncsiHeaderSize + padded;
+        uint32_t received = static_cast<uint32_t>(
+            checksum[0] << 24 | checksum[1] << 16 | checksum[2] << 8 |
+            checksum[3]);
+        // A zero checksum means the requester did not compute one
+        if (received != 0 &&
+            received != ncsiChecksum(packet, ncsiHeaderSize + payloadLength))
+        {
+            stats.checksumErrors++;
+            return std::nullopt;
+        }
+    }
+
+    stats.commandsReceived++;
+
+    std::vector<uint8_t> out(1 + ncsiHeaderSize, 0);
+    out[0] = request[0];
+    out[2] = ncsiHeaderRevision;
+    out[4] = iid;
+    out[5] = command | ncsiResponseBit;
+    out[6] = channelId;
+    appendBe(out, ncsiCompleted, 2);
+    appendBe(out, ncsiNoReason, 2);
+
+    switch (command)
+    {
+        case ncsiGetVersionId:
+        {
+            // NC-SI 1.1.0
+            std::array<uint8_t, 8> version = {0xF1, 0xF1, 0xF0, 0x00,
+                                              0x00, 0x00, 0x00, 0x00};
+            out.insert(out.end(), version.begin(), version.end());
+            std::array<uint8_t, 12> name{};
+            std::copy_n(params.firmwareName.begin(),
+                        std::min(name.size(), params.firmwareName.size()),
+                        name.begin());
+            out.insert(out.end(), name.begin(), name.end());
+            appendBe(out, params.firmwareVersion, 4);
+            appendBe(out, params.pciDeviceId, 2);
+            appendBe(out, params.pciVendorId, 2);
+            appendBe(out, 0, 2);
+            appendBe(out, params.pciVendorId, 2);
+            appendBe(out, params.manufacturerId, 4);
+            break;
+        }
+        case ncsiGetCapabilities:
+            // Hardware arbitration, OS presence, flow control
+            appendBe(out, 0x00000007, 4);
+            // Broadcast and multicast filters, buffering, AEN control
+            appendBe(out, 0x0000000F, 4);
+            appendBe(out, 0x00000007, 4);
+            appendBe(out, 16 * 1024, 4);
+            appendBe(out, 0x00000007, 4);
+            // VLAN, mixed, multicast and unicast filter counts
+            out.insert(out.end(), {4, 0, 4, 4, 0, 0});
+            // VLAN mode support, channel count
+            out.push_back(0x07);
+            out.push_back(params.channels);
+            break;
+        case ncsiGetLinkStatus:
+            // Link up, speed and duplex, auto negotiation enabled and done
+            appendBe(out,
+                     0x01U | static_cast<uint32_t>(params.speedDuplex << 1) |
+                         0x60U,
+                     4);
+            // Host NC driver status and OEM link status
+            appendBe(out, 0, 4);
+            appendBe(out, 0, 4);
+            break;
+        case ncsiGetControllerStatistics:
+            controllerStatistics(stats, out);
+            break;
+        case ncsiGetNcsiStatistics:
+            appendBe(out, stats.commandsReceived, 4);
+            // Control packets dropped
+            appendBe(out, stats.checksumErrors, 4);
+            appendBe(out, stats.commandTypeErrors, 4);
+            appendBe(out, stats.checksumErrors, 4);
+            appendBe(out, stats.packetsReceived, 4);
+            // Including this response
+            appendBe(out, stats.packetsTransmitted + 1, 4);
+            // AENs sent
+            appendBe(out, 0, 4);
+            break;
+        case ncsiGetPassThroughStatistics:
+            passThroughStatistics(stats, out);
+            break;
+        case ncsiOem:
+        {
+            // No OEM commands of our own, whoever's they are
+            out.resize(1 + ncsiHeaderSize);
+            if (payloadLength < 4 || request.size() < 1 + ncsiHeaderSize + 4)
+            {
+                appendBe(out, ncsiFailed, 2);
+                appendBe(out, ncsiInvalidPayloadLength, 2);
+                break;
+            }
+            appendBe(out, ncsiUnsupported, 2);
+            appendBe(out, ncsiUnknownCommand, 2);
+            const uint8_t* manufacturerId = packet + ncsiHeaderSize;
+            out.insert(out.end(), manufacturerId, manufacturerId + 4);
+            break;
+        }
+        default:
+            stats.commandTypeErrors++;
+            out.resize(1 + ncsiHeaderSize);
+            appendBe(out, ncsiUnsupported, 2);
+            appendBe(out, ncsiUnknownCommand, 2);
+            break;
+    }
+    stats.packetsTransmitted++;
+
+    size_t responseLength = out.size() - 1 - ncsiHeaderSize;
+    out[7] = static_cast<uint8_t>(responseLength >> 8);
+    out[8] = static_cast<uint8_t>(responseLength);
+    out.resize(1 + ncsiHeaderSize + ((responseLength + 3) & ~size_t{3}), 0);
+    appendBe(out, ncsiChecksum(&out[1], ncsiHeaderSize + responseLength), 4);
+
+    return MctpResponse{params.processingDelay, std::move(out), {}};
+}
@@ -0,0 +1,421 @@
+#include "NvmeDevice.hpp"
+
+#include "ByteOrder.hpp"
+#include "Crc.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// NVMe-MI message header, the message type byte included
+constexpr size_t nvmeMiHeaderSize = 4;
+constexpr uint8_t nvmeMiMessageType = 0x04;
+constexpr uint8_t integrityCheckBit = 0x80;
+constexpr uint8_t responseBit = 0x80;
+constexpr uint8_t nvmeMiTypeAdmin = 0x02;
+constexpr size_t micSize = 4;
+
+// NVMe Admin Command request: opcode, flags, controller ID, submission queue
+// entry dwords 1 to 5, data offset and length, two reserved dwords, then
+// dwords 10 to 15
+constexpr size_t adminRequestSize = 68;
+constexpr uint8_t dataLengthValid = 0x01;
+constexpr uint8_t dataOffsetValid = 0x02;
+constexpr size_t maxResponseData = 4096;
+
+// Status, three reserved bytes and completion queue entry dwords 0, 1 and 3,
+// following the NVMe-MI message header
+constexpr size_t adminResponseSize = 16;
+
+// NVMe-MI response message status
+constexpr uint8_t miSuccess = 0x00;
+constexpr uint8_t miInvalidParameter = 0x04;
+constexpr uint8_t miInvalidCommandSize = 0x05;
+
+// Admin command opcodes
+constexpr uint8_t nvmeGetLogPage = 0x02;
+constexpr uint8_t nvmeIdentify = 0x06;
+constexpr uint8_t nvmeGetFeatures = 0x0A;
+
+// Completion status fields, status code type in bits 10:8
+constexpr uint16_t nvmeSuccess = 0x0000;
+constexpr uint16_t nvmeInvalidField = 0x0002;
+constexpr uint16_t nvmeInvalidNamespace = 0x000B;
+constexpr uint16_t nvmeInvalidLogPage = 0x0109;
+constexpr uint16_t nvmeUnrecoveredReadError = 0x0281;
+
+// Identify CNS values and log page identifiers
+constexpr uint8_t cnsNamespace = 0x00;
+constexpr uint8_t cnsController = 0x01;
+constexpr uint8_t logErrorInformation = 0x01;
+constexpr uint8_t logSmartHealth = 0x02;
+constexpr uint8_t logTelemetryHost = 0x07;
+constexpr uint8_t logTelemetryController = 0x08;
+
+constexpr size_t errorEntrySize = 64;
+constexpr size_t smartLogSize = 512;
+constexpr size_t telemetryBlockSize = 512;
+
+static const std::array<uint8_t, 3> ieeeOui = {0xE4, 0xD2, 0x5C};
+
+// ASCII field padded with spaces
+static void writeString(uint8_t* out, const std::string& value, size_t size)
+{
+    std::memset(out, ' ', size);
+    std::memcpy(out, value.data(), std::min(size, value.size()));
+}
+
+NvmeDeviceResponder::NvmeDeviceResponder(const Params& deviceParams) :
+    params(deviceParams), start(std::chrono::steady_clock::now())
+{
+    // The controller reports the count less one in a byte
+    params.errorLogEntries = std::clamp(params.errorLogEntries, 1U, 256U);
+    params.namespaceBlocks = std::max<uint64_t>(params.namespaceBlocks, 1);
+
+    uint8_t* id = identifyController.data();
+    writeLe(&id[0], params.pciVendorId, 2);
+    writeLe(&id[2], params.pciVendorId, 2);
+    writeString(&id[4], params.serialNumber, 20);
+    writeString(&id[24], params.modelNumber, 40);
+    writeString(&id[64], params.firmwareRevision, 8);
+    std::copy(ieeeOui.begin(), ieeeOui.end(), &id[73]);
+    // Maximum data transfer size of 2^5 pages, NVMe 1.4
+    id[77] = 5;
+    writeLe(&id[80], 0x00010400, 4);
+    // Three outstanding AERs, extended data and telemetry for Get Log Page
+    id[259] = 3;
+    id[261] = 0x0C;
+    id[262] = static_cast<uint8_t>(params.errorLogEntries - 1);
+    // Warning and critical composite temperature thresholds
+    writeLe(&id[266], 343, 2);
+    writeLe(&id[268], 353, 2);
+    writeLe(&id[280], params.namespaceBlocks << params.blockSizeShift, 8);
+    id[512] = 0x66;
+    id[513] = 0x44;
+    writeLe(&id[516], 1, 4);
+    id[525] = 0x01;
+
+    uint8_t* ns = identifyNamespace.data();
+    writeLe(&ns[0], params.namespaceBlocks, 8);
+    writeLe(&ns[8], params.namespaceBlocks, 8);
+    writeLe(&ns[16], params.namespaceBlocks, 8);
+    // One LBA format, in use
+    ns[130] = params.blockSizeShift;
+}
+
+bool NvmeDeviceResponder::handles(const std::vector<uint8_t>& request) const
+{
+    size_t minSize = adminRequestSize;
+    if (!request.empty() && (request[0] & integrityCheckBit))
+    {
+        minSize += micSize;
+    }
+    if (request.size() < minSize ||
+        (request[0] & ~integrityCheckBit) != nvmeMiMessageType ||
+        (request[1] & responseBit) ||
+        ((request[1] >> 3) & 0x0F) != nvmeMiTypeAdmin)
+    {
+        return false;
+    }
+    return request[4] == nvmeGetLogPage || request[4] == nvmeIdentify ||
+           request[4] == nvmeGetFeatures;
+}
+
+uint64_t NvmeDeviceResponder::logSize(uint8_t logId) const
+{
+    switch (logId)
+    {
+        case logErrorInformation:
+            return uint64_t{params.errorLogEntries} * errorEntrySize;
+        case logSmartHealth:
+            return smartLogSize;
+        case logTelemetryHost:
+        case logTelemetryController:
+            // Header block, then all three data areas end at the same block
+            return (uint64_t{params.telemetryBlocks} + 1) * telemetryBlockSize;
+        default:
+            return 0;
+    }
+}
+
+void NvmeDeviceResponder::smartLog(uint8_t* log) const
+{
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    auto reads = static_cast<uint64_t>(params.readCommandsPerSec * seconds);
+    auto writes = static_cast<uint64_t>(params.writeCommandsPerSec * seconds);
+    auto uptime = static_cast<uint64_t>(seconds);
+
+    std::memset(log, 0, smartLogSize);
+    writeLe(&log[1], params.temperature, 2);
+    // Available spare and its threshold
+    log[3] = 100;
+    log[4] = 10;
+    log[5] = params.percentageUsed;
+    // Data units are thousands of 512 byte units, commands move 4 KiB
+    writeLe(&log[32], reads * 8 / 1000, 8);
+    writeLe(&log[48], writes * 8 / 1000, 8);
+    writeLe(&log[64], reads, 8);
+    writeLe(&log[80], writes, 8);
+    // Controller busy minutes
+    writeLe(&log[96], uptime / 60, 8);
+    writeLe(&log[112], params.powerCycles, 8);
+    writeLe(&log[128], params.powerOnHours + uptime / 3600, 8);
+    writeLe(&log[176], params.errorLogEntries, 8);
+    writeLe(&log[200], params.temperature, 2);
+}
+
+bool NvmeDeviceResponder::readLog(uint8_t logId, uint64_t offset,
+                                  uint8_t* out, size_t size) const
+{
+    uint64_t total = logSize(logId);
+    if (offset > total)
+    {
+        return false;
+    }
+    // Past the end of the log reads as zeros
+    std::memset(out, 0, size);
+    size = static_cast<size_t>(std::min<uint64_t>(size, total - offset));
+
+    if (logId == logSmartHealth)
+    {
+        std::array<uint8_t, smartLogSize> log;
+        smartLog(log.data());
+        std::copy_n(log.begin() + static_cast<std::ptrdiff_t>(offset), size,
+                    out);
+        return true;
+    }
+
+    size_t done = 0;
+    while (done < size)
+    {
+        uint64_t position = offset + done;
+        if (logId == logErrorInformation)
+        {
+            // Newest entry first
+            uint64_t index = position / errorEntrySize;
+            std::array<uint8_t, errorEntrySize> entry{};
+            writeLe(&entry[0], params.errorLogEntries - index, 8);
+            writeLe(&entry[8], index % 8 + 1, 2);
+            writeLe(&entry[10], index * 7, 2);
+            writeLe(&entry[12], nvmeUnrecoveredReadError << 1, 2);
+            writeLe(&entry[14], 0xFFFF, 2);
+            writeLe(&entry[16], (index * 2654435761U) % params.namespaceBlocks,
+                    8);
+            writeLe(&entry[24], 1, 4);
+            size_t at = position % errorEntrySize;
+            size_t count = std::min(errorEntrySize - at, size - done);
+            std::copy_n(entry.begin() + static_cast<std::ptrdiff_t>(at), count,
+                        out + done);
+            done += count;
+        }
+        else if (position < telemetryBlockSize)
+        {
+            std::array<uint8_t, telemetryBlockSize> header{};
+            header[0] = logId;
+            std::copy(ieeeOui.begin(), ieeeOui.end(), &header[5]);
+            for (size_t area = 0; area < 3; area++)
+            {
+                writeLe(&header[8 + 2 * area], params.telemetryBlocks, 2);
+            }
+            header[381] = hostTelemetryGeneration;
+            header[382] = logId == logTelemetryController ? 1 : 0;
+            size_t count = std::min(telemetryBlockSize - position, size - done);
+            std::copy_n(header.begin() + static_cast<std::ptrdiff_t>(position),
+                        count, out + done);
+            done += count;
+        }
+        else
+        {
+            // Telemetry data, a pure function of the position and generation
+            uint32_t seed = logId == logTelemetryHost
+                                ? hostTelemetryGeneration * 0x01000193U
+                                : 0;
+            for (; done < size; done++)
+            {
+                auto at = static_cast<uint32_t>(offset + done) + seed;
+                out[done] = static_cast<uint8_t>((at * 2654435761U) >> 24);
+            }
+        }
+    }
+    return true;
+}
+
+uint16_t NvmeDeviceResponder::getFeatures(uint8_t featureId, uint8_t select,
+                                          uint32_t& result) const
+{
+    switch (featureId)
+    {
+        case 0x01: // Arbitration
+            result = 0x00000003;
+            break;
+        case 0x02: // Power Management
+        case 0x05: // Error Recovery
+        case 0x08: // Interrupt Coalescing
+            result = 0;
+            break;
+        case 0x04: // Temperature Threshold
+            result = 343;
+            break;
+        case 0x06: // Volatile Write Cache
+            result = 1;
+            break;
+        case 0x07: // Number of Queues, 64 of each
+            result = 0x003F003F;
+            break;
+        case 0x0B: // Asynchronous Event Configuration
+            result = 0x0000011F;
+            break;
+        default:
+            return nvmeInvalidField;
+    }
+    // Supported capabilities: changeable, not saveable
+    if (select == 3)
+    {
+        result = 0x4;
+    }
+    else if (select > 3)
+    {
+        return nvmeInvalidField;
+    }
+    return nvmeSuccess;
+}
+
+std::optional<MctpResponse>
+    NvmeDeviceResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (!handles(request))
+    {
+        return std::nullopt;
+    }
+    bool integrityCheck = request[0] & integrityCheckBit;
+    size_t size = request.size();
+    if (integrityCheck)
+    {
+        size -= micSize;
+        // Messages that fail the integrity check are discarded
+        if (crc32c(request.data(), size) != readLe(&request[size], micSize))
+        {
+            return std::nullopt;
+        }
+    }
+
+    const uint8_t* command = request.data();
+    uint8_t opcode = command[4];
+    uint8_t flags = command[5];
+    auto nsid = static_cast<uint32_t>(readLe(&command[8], 4));
+    auto dataOffset = static_cast<uint32_t>(readLe(&command[28], 4));
+    auto dataLength = static_cast<uint32_t>(readLe(&command[32], 4));
+    auto dw10 = static_cast<uint32_t>(readLe(&command[44], 4));
+    auto dw11 = static_cast<uint32_t>(readLe(&command[48], 4));
+    uint64_t logOffset = readLe(&command[52], 8);
+
+    std::vector<uint8_t> out(nvmeMiHeaderSize + adminResponseSize, 0);
+    out[0] = request[0];
+    out[1] = request[1] | responseBit;
+    uint16_t status = nvmeSuccess;
+    uint32_t dw0 = 0;
+
+    // Length of the data the command transfers, before the NVMe-MI data
+    // offset and length select a part of it
+    uint64_t commandData = 0;
+    if (opcode == nvmeIdentify)
+    {
+        commandData = identifyController.size();
+    }
+    else if (opcode == nvmeGetLogPage)
+    {
+        uint64_t dwords = ((dw11 & 0xFFFF) << 16 | dw10 >> 16) + uint64_t{1};
+        commandData = dwords * 4;
+    }
+    uint64_t offset = (flags & dataOffsetValid) ? dataOffset : 0;
+    uint64_t length = (flags & dataLengthValid) ? dataLength
+                                                : commandData - offset;
+
+    if (size != adminRequestSize)
+    {
+        out[4] = miInvalidCommandSize;
+    }
+    else if (offset + length > commandData || length > maxResponseData ||
+             offset % 4 || length % 4)
+    {
+        out[4] = miInvalidParameter;
+    }
+    else
+    {
+        out[4] = miSuccess;
+        size_t dataStart = out.size();
+        out.resize(dataStart + length);
+        uint8_t* data = out.data() + dataStart;
+        switch (opcode)
+        {
+            case nvmeIdentify:
+            {
+                auto cns = static_cast<uint8_t>(dw10);
+                if (cns == cnsController)
+                {
+                    std::copy_n(identifyController.begin() + offset, length,
+                                data);
+                }
+                else if (cns != cnsNamespace)
+                {
+                    status = nvmeInvalidField;
+                }
+                else if (nsid != 1)
+                {
+                    status = nvmeInvalidNamespace;
+                }
+                else
+                {
+                    std::copy_n(identifyNamespace.begin() + offset, length,
+                                data);
+                }
+                break;
+            }
+            case nvmeGetLogPage:
+            {
+                auto logId = static_cast<uint8_t>(dw10);
+                if (logSize(logId) == 0)
+                {
+                    status = nvmeInvalidLogPage;
+                    break;
+                }
+                if (logOffset % 4)
+                {
+                    status = nvmeInvalidField;
+                    break;
+                }
+                // Create Telemetry Host-Initiated Data
+                if (logId == logTelemetryHost && (dw10 & 0x100) &&
+                    logOffset == 0)
+                {
+                    hostTelemetryGeneration++;
+                }
+                if (!readLog(logId, logOffset + offset, data, length))
+                {
+                    status = nvmeInvalidField;
+                }
+                break;
+            }
+            case nvmeGetFeatures:
+                status = getFeatures(static_cast<uint8_t>(dw10),
+                                     static_cast<uint8_t>((dw10 >> 8) & 0x7),
+                                     dw0);
+                break;
+        }
+        if (status != nvmeSuccess)
+        {
+            out.resize(dataStart);
+        }
+    }
+
+    writeLe(&out[8], dw0, 4);
+    // Status field above the phase tag, command identifier zero
+    writeLe(&out[16], uint32_t{status} << 17, 4);
+    if (integrityCheck)
+    {
+        appendLe(out, crc32c(out.data(), out.size()), micSize);
+    }
+
+    return MctpResponse{params.processingDelay, std::move(out), {}};
+}
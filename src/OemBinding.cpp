@@ -1,19 +1,46 @@
 #include "OemBinding.hpp"
 
+#include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
 
 std::string mctpBindSMBus = "xyz.openbmc_project.MCTP.Binding.SMBus";
 std::string mctpBindPCIe = "xyz.openbmc_project.MCTP.Binding.PCIe";
 std::string mctpBindOem = "xyz.openbmc_project.MCTP.Binding.OEM";
+std::string mctpBindI3C = "xyz.openbmc_project.MCTP.Binding.I3C";
+std::string mctpBindUSB = "xyz.openbmc_project.MCTP.Binding.USB";
+std::string mctpBindKCS = "xyz.openbmc_project.MCTP.Binding.KCS";
 std::string path = "/dev/i2c-8";
 uint8_t arpMasterSupport = 0;
 uint8_t bmcSlaveAddress = 0x12;
 std::string pcieDiscoveredFlag = "xyz.openbmc_project.MCTP.Binding.PCIe.DiscoveryFlags.Discovered";
+std::string i3cBusPath = "/dev/i3c-mctp-0";
+uint8_t i3cDynamicAddress = 0x08;
+std::string usbBusPath = "/dev/bus/usb/001/002";
+uint16_t kcsIoPort = 0xCA2;
+
+// Link parameter that must not be 0: a zero MTU never finishes packetizing a
+// message and a zero clock has no bit time. Those keep the default.
+template <typename T>
+static T nonZeroLinkValue(const nlohmann::json& linkConfig,
+                          const std::string& key, T defaultValue)
+{
+    T value = linkConfig.value(key, defaultValue);
+    if (value == 0)
+    {
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            ("mctp-emulator: Ignoring link " + key + " of 0, using " +
+             std::to_string(defaultValue))
+                .c_str());
+        return defaultValue;
+    }
+    return value;
+}
 
 OemBinding::OemBinding(
     std::shared_ptr<sdbusplus::asio::object_server>& objServer,
-    std::string& objPath, bindType bind) :
-    MctpBinding(objServer, objPath)
+    std::string& objPath, bindType bind, unsigned workerThreads,
+    unsigned computeThreads, const nlohmann::json& linkConfig) :
+    MctpBinding(objServer, objPath, workerThreads, computeThreads)
 {
     if (bind == bindType::smbus)
     {
@@ -28,6 +55,66 @@ OemBinding::OemBinding(
         dbusInterface->register_property("DiscoveredFlag", pcieDiscoveredFlag);
         dbusInterface->register_property("BDF", 512);
     }
+    else if (bind == bindType::i3c)
+    {
+        I3CTimingModel::Params params;
+        std::string mode = linkConfig.value("mode", "sdr");
+        params.hdrDdr = (mode == "hdr-ddr");
+        params.clockHz =
+            nonZeroLinkValue(linkConfig, "clock-hz", params.clockHz);
+        params.mtu = nonZeroLinkValue(linkConfig, "mtu", params.mtu);
+        params.ibiLatencyUs =
+            linkConfig.value("ibi-latency-us", params.ibiLatencyUs);
+        linkModel = std::make_shared<I3CTimingModel>(params);
+
+        dbusInterface = objServer->add_interface(objPath, mctpBindI3C);
+        dbusInterface->register_property("BusPath", i3cBusPath);
+        dbusInterface->register_property("DynamicAddress", i3cDynamicAddress);
+        dbusInterface->register_property(
+            "Mode", std::string(params.hdrDdr ? "HDR-DDR" : "SDR"));
+        dbusInterface->register_property("ClockHz", params.clockHz);
+        dbusInterface->register_property("MTU",
+                                         static_cast<uint32_t>(params.mtu));
+        dbusInterface->register_property("IbiLatencyUs", params.ibiLatencyUs);
+    }
+    else if (bind == bindType::usb)
+    {
+        UsbTimingModel::Params params;
+        std::string speed = linkConfig.value("speed", "high");
+        params.highSpeed = (speed != "full");
+        params.maxPacketSize = params.highSpeed ? 512 : 64;
+        params.mtu = nonZeroLinkValue(linkConfig, "mtu", params.mtu);
+        params.transferOverheadUs = linkConfig.value(
+            "transfer-overhead-us", params.transferOverheadUs);
+        params.inPollIntervalUs =
+            linkConfig.value("in-poll-interval-us", params.inPollIntervalUs);
+        linkModel = std::make_shared<UsbTimingModel>(params);
+
+        dbusInterface = objServer->add_interface(objPath, mctpBindUSB);
+        dbusInterface->register_property("BusPath", usbBusPath);
+        dbusInterface->register_property(
+            "Speed", std::string(params.highSpeed ? "HighSpeed" : "FullSpeed"));
+        dbusInterface->register_property(
+            "MaxPacketSize", static_cast<uint16_t>(params.maxPacketSize));
+        dbusInterface->register_property("MTU",
+                                         static_cast<uint32_t>(params.mtu));
+    }
+    else if (bind == bindType::kcs)
+    {
+        KcsTimingModel::Params params;
+        params.byteLatencyUs =
+            linkConfig.value("byte-latency-us", params.byteLatencyUs);
+        params.mtu = nonZeroLinkValue(linkConfig, "mtu", params.mtu);
+        params.attentionLatencyUs =
+            linkConfig.value("attention-latency-us", params.attentionLatencyUs);
+        linkModel = std::make_shared<KcsTimingModel>(params);
+
+        dbusInterface = objServer->add_interface(objPath, mctpBindKCS);
+        dbusInterface->register_property("IoPort", kcsIoPort);
+        dbusInterface->register_property("ByteLatencyUs", params.byteLatencyUs);
+        dbusInterface->register_property("MTU",
+                                         static_cast<uint32_t>(params.mtu));
+    }
     else
     {
         dbusInterface = objServer->add_interface(objPath, mctpBindOem);
@@ -0,0 +1,373 @@
+#include "PlantModel.hpp"
+
+#include "ByteOrder.hpp"
+#include "PldmMessage.hpp"
+
+#include <cmath>
+
+// Platform Monitoring and Control commands (DSP0248), besides
+// GetSensorReading
+constexpr uint8_t pldmSetNumericEffecterValue = 0x31;
+constexpr uint8_t pldmGetNumericEffecterValue = 0x32;
+constexpr uint8_t pldmSetStateEffecterStates = 0x39;
+constexpr uint8_t pldmGetStateEffecterStates = 0x3A;
+
+// Effecter update pending and state effecter set request fields
+constexpr uint8_t pldmEffecterNoUpdatePending = 0x01;
+constexpr uint8_t pldmStateNoChange = 0x00;
+constexpr uint8_t pldmStateRequestSet = 0x01;
+
+PlantModel::PlantModel(boost::asio::io_context& ioc,
+                       const Params& plantParams) :
+    params(plantParams),
+    stepTimer(ioc)
+{
+    for (size_t i = 0; i < params.numericEffecters.size(); i++)
+    {
+        numericIndex.emplace(params.numericEffecters[i].id, i);
+    }
+    for (size_t i = 0; i < params.stateEffecters.size(); i++)
+    {
+        stateIndex.emplace(params.stateEffecters[i].id, i);
+    }
+    double step = std::chrono::duration<double>(params.step).count();
+    for (size_t i = 0; i < params.sensors.size(); i++)
+    {
+        const Sensor& s = params.sensors[i];
+        sensorIndex.emplace(s.id, i);
+        double tau = std::chrono::duration<double>(s.timeConstant).count();
+        // Exact discretization of the lag, stable for any step size
+        smoothing.push_back(tau > 0 ? 1 - std::exp(-step / tau) : 1);
+    }
+}
+
+PlantModel::~PlantModel()
+{
+    stepTimer.cancel();
+}
+
+void PlantModel::start()
+{
+    if (params.step.count() <= 0 || params.sensors.empty())
+    {
+        return;
+    }
+    stepTimer.expires_after(params.step);
+    scheduleStep();
+}
+
+void PlantModel::scheduleStep()
+{
+    stepTimer.async_wait(
+        [weak = weak_from_this()](const boost::system::error_code& ec) {
+            auto self = weak.lock();
+            if (ec || !self)
+            {
+                return;
+            }
+            self->integrate();
+            // Relative to the last expiry, so that the step does not drift
+            self->stepTimer.expires_at(self->stepTimer.expiry() +
+                                       self->params.step);
+            self->scheduleStep();
+        });
+}
+
+double PlantModel::inputValue(uint16_t effecterId) const
+{
+    if (auto numeric = numericIndex.find(effecterId);
+        numeric != numericIndex.end())
+    {
+        return params.numericEffecters[numeric->second].value;
+    }
+    if (auto state = stateIndex.find(effecterId); state != stateIndex.end())
+    {
+        const auto& states = params.stateEffecters[state->second].states;
+        return states.empty() ? 0 : states.front();
+    }
+    return 0;
+}
+
+void PlantModel::integrate()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < params.sensors.size(); i++)
+    {
+        Sensor& s = params.sensors[i];
+        double target = s.ambient;
+        for (const Input& input : s.inputs)
+        {
+            target += input.gain * inputValue(input.effecterId);
+        }
+        s.value += smoothing[i] * (target - s.value);
+    }
+}
+
+const PlantModel::NumericEffecter*
+    PlantModel::numericEffecter(uint16_t id) const
+{
+    auto iter = numericIndex.find(id);
+    return iter == numericIndex.end()
+               ? nullptr
+               : &params.numericEffecters[iter->second];
+}
+
+bool PlantModel::hasStateEffecter(uint16_t id) const
+{
+    return stateIndex.count(id) != 0;
+}
+
+const PlantModel::Sensor* PlantModel::sensor(uint16_t id) const
+{
+    auto iter = sensorIndex.find(id);
+    return iter == sensorIndex.end() ? nullptr : &params.sensors[iter->second];
+}
+
+std::optional<double> PlantModel::sensorValue(uint16_t id)
+{
+    auto iter = sensorIndex.find(id);
+    if (iter == sensorIndex.end())
+    {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    return params.sensors[iter->second].value;
+}
+
+std::optional<double> PlantModel::numericValue(uint16_t id)
+{
+    auto iter = numericIndex.find(id);
+    if (iter == numericIndex.end())
+    {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    return params.numericEffecters[iter->second].value;
+}
+
+bool PlantModel::setNumericValue(uint16_t id, double value)
+{
+    auto iter = numericIndex.find(id);
+    if (iter == numericIndex.end())
+    {
+        return false;
+    }
+    NumericEffecter& effecter = params.numericEffecters[iter->second];
+    if (value < effecter.min || value > effecter.max)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    effecter.value = value;
+    return true;
+}
+
+std::optional<std::vector<uint8_t>> PlantModel::states(uint16_t id)
+{
+    auto iter = stateIndex.find(id);
+    if (iter == stateIndex.end())
+    {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    return params.stateEffecters[iter->second].states;
+}
+
+bool PlantModel::setStates(uint16_t id,
+                           const std::vector<std::optional<uint8_t>>& requested)
+{
+    auto iter = stateIndex.find(id);
+    if (iter == stateIndex.end())
+    {
+        return false;
+    }
+    StateEffecter& effecter = params.stateEffecters[iter->second];
+    if (requested.size() != effecter.states.size())
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < requested.size(); i++)
+    {
+        if (requested[i])
+        {
+            effecter.states[i] = *requested[i];
+        }
+    }
+    return true;
+}
+
+// Effecter value of the given PLDM data size, nullopt when the size is not
+// an integer one or the value is truncated
+static std::optional<int64_t> readValue(const std::vector<uint8_t>& request,
+                                        size_t offset, uint8_t dataSize)
+{
+    // uint8, sint8, uint16, sint16, uint32, sint32
+    if (dataSize > 5)
+    {
+        return std::nullopt;
+    }
+    size_t size = size_t{1} << (dataSize / 2);
+    if (request.size() != offset + size)
+    {
+        return std::nullopt;
+    }
+    auto raw = static_cast<uint32_t>(readLe(&request[offset], size));
+    bool isSigned = dataSize % 2;
+    if (!isSigned)
+    {
+        return raw;
+    }
+    uint32_t signBit = uint32_t{1} << (8 * size - 1);
+    return static_cast<int64_t>(raw ^ signBit) - static_cast<int64_t>(signBit);
+}
+
+PldmPlantResponder::PldmPlantResponder(std::shared_ptr<PlantModel> plantModel,
+                                       int processingDelay) :
+    plant(std::move(plantModel)),
+    delay(processingDelay)
+{}
+
+bool PldmPlantResponder::handles(const std::vector<uint8_t>& request) const
+{
+    // Every command handled here starts with a sensor or effecter ID
+    if (!isPldmRequest(request, pldmTypePlatform) ||
+        request.size() < pldmHeaderSize + 2)
+    {
+        return false;
+    }
+
+    uint16_t id = static_cast<uint16_t>(request[4] | request[5] << 8);
+    switch (request[3])
+    {
+        case pldmGetSensorReading:
+            return plant->sensor(id) != nullptr;
+        case pldmSetNumericEffecterValue:
+        case pldmGetNumericEffecterValue:
+            return plant->numericEffecter(id) != nullptr;
+        case pldmSetStateEffecterStates:
+        case pldmGetStateEffecterStates:
+            return plant->hasStateEffecter(id);
+        default:
+            return false;
+    }
+}
+
+std::optional<MctpResponse>
+    PldmPlantResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (!handles(request))
+    {
+        return std::nullopt;
+    }
+
+    uint16_t id = static_cast<uint16_t>(request[4] | request[5] << 8);
+    std::vector<uint8_t> out = pldmResponseHeader(request);
+
+    switch (request[3])
+    {
+        case pldmGetSensorReading:
+        {
+            // The rearm event state byte is accepted but there are no
+            // thresholds to rearm
+            if (request.size() != pldmHeaderSize + 3)
+            {
+                out[4] = pldmErrorInvalidLength;
+                break;
+            }
+            double value = plant->sensorValue(id).value_or(0);
+            appendSensorReading(out, pldmDataSizeSint32,
+                                value / plant->sensor(id)->resolution);
+            break;
+        }
+        case pldmSetNumericEffecterValue:
+        {
+            if (request.size() < pldmHeaderSize + 4)
+            {
+                out[4] = pldmErrorInvalidLength;
+                break;
+            }
+            auto raw = readValue(request, pldmHeaderSize + 3, request[6]);
+            if (!raw)
+            {
+                out[4] = request[6] > 5 ? pldmErrorInvalidData
+                                        : pldmErrorInvalidLength;
+                break;
+            }
+            double value = static_cast<double>(*raw) *
+                           plant->numericEffecter(id)->resolution;
+            if (!plant->setNumericValue(id, value))
+            {
+                out[4] = pldmErrorInvalidData;
+            }
+            break;
+        }
+        case pldmGetNumericEffecterValue:
+        {
+            if (request.size() != pldmHeaderSize + 2)
+            {
+                out[4] = pldmErrorInvalidLength;
+                break;
+            }
+            double raw = plant->numericValue(id).value_or(0) /
+                         plant->numericEffecter(id)->resolution;
+            // Writes take effect at once, so pending equals present
+            out.push_back(pldmDataSizeSint32);
+            out.push_back(pldmEffecterNoUpdatePending);
+            appendPldmValue(out, pldmDataSizeSint32, raw);
+            appendPldmValue(out, pldmDataSizeSint32, raw);
+            break;
+        }
+        case pldmSetStateEffecterStates:
+        {
+            if (request.size() < pldmHeaderSize + 3 ||
+                request.size() != pldmHeaderSize + 3 + 2 * size_t{request[6]})
+            {
+                out[4] = pldmErrorInvalidLength;
+                break;
+            }
+            std::vector<std::optional<uint8_t>> requested;
+            bool valid = true;
+            for (size_t i = 0; i < request[6]; i++)
+            {
+                uint8_t setRequest = request[pldmHeaderSize + 3 + 2 * i];
+                if (setRequest == pldmStateRequestSet)
+                {
+                    requested.emplace_back(
+                        request[pldmHeaderSize + 4 + 2 * i]);
+                }
+                else if (setRequest == pldmStateNoChange)
+                {
+                    requested.emplace_back(std::nullopt);
+                }
+                else
+                {
+                    valid = false;
+                }
+            }
+            if (!valid || !plant->setStates(id, requested))
+            {
+                out[4] = pldmErrorInvalidData;
+            }
+            break;
+        }
+        case pldmGetStateEffecterStates:
+        {
+            if (request.size() != pldmHeaderSize + 2)
+            {
+                out[4] = pldmErrorInvalidLength;
+                break;
+            }
+            auto states = plant->states(id).value_or(std::vector<uint8_t>{});
+            out.push_back(static_cast<uint8_t>(states.size()));
+            for (uint8_t state : states)
+            {
+                out.insert(out.end(),
+                           {pldmEffecterNoUpdatePending, state, state});
+            }
+            break;
+        }
+    }
+
+    return MctpResponse{delay, std::move(out), {}};
+}
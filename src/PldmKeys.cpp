@@ -0,0 +1,190 @@
+#include "PldmKeys.hpp"
+
+#include "ByteOrder.hpp"
+#include "PldmMessage.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+using json = nlohmann::json;
+
+namespace
+{
+
+// PLDM type, command byte and the fields after them
+constexpr size_t commandSize = 2;
+
+constexpr uint16_t commandIndex(uint8_t type, uint8_t command)
+{
+    return static_cast<uint16_t>(type << 8 | command);
+}
+
+} // namespace
+
+const std::vector<PldmKeyIndex::Field>&
+    PldmKeyIndex::commandFields(uint16_t command)
+{
+    static const std::vector<Field> sensor = {{"sensor-id", 0, 2}};
+    static const std::vector<Field> effecter = {{"effecter-id", 0, 2}};
+    // recordHandle, dataTransferHandle, transferOperationFlag
+    static const std::vector<Field> getPdr = {{"record-handle", 0, 4},
+                                              {"transfer-flag", 8, 1}};
+    // dataTransferHandle, transferOperationFlag, tableType
+    static const std::vector<Field> getBiosTable = {{"transfer-flag", 4, 1},
+                                                    {"table-type", 5, 1}};
+    static const std::vector<Field> none;
+    static const std::unordered_map<uint16_t, const std::vector<Field>*>
+        layouts = {
+            // SetNumericSensorEnable .. InitNumericSensor
+            {commandIndex(pldmTypePlatform, 0x10), &sensor},
+            {commandIndex(pldmTypePlatform, 0x11), &sensor},
+            {commandIndex(pldmTypePlatform, 0x12), &sensor},
+            {commandIndex(pldmTypePlatform, 0x13), &sensor},
+            {commandIndex(pldmTypePlatform, 0x14), &sensor},
+            {commandIndex(pldmTypePlatform, 0x15), &sensor},
+            {commandIndex(pldmTypePlatform, 0x16), &sensor},
+            {commandIndex(pldmTypePlatform, 0x17), &sensor},
+            // SetStateSensorEnables .. InitStateSensor
+            {commandIndex(pldmTypePlatform, 0x20), &sensor},
+            {commandIndex(pldmTypePlatform, 0x21), &sensor},
+            {commandIndex(pldmTypePlatform, 0x22), &sensor},
+            // SetNumericEffecterEnable .. GetNumericEffecterValue
+            {commandIndex(pldmTypePlatform, 0x30), &effecter},
+            {commandIndex(pldmTypePlatform, 0x31), &effecter},
+            {commandIndex(pldmTypePlatform, 0x32), &effecter},
+            // SetStateEffecterEnables .. GetStateEffecterStates
+            {commandIndex(pldmTypePlatform, 0x38), &effecter},
+            {commandIndex(pldmTypePlatform, 0x39), &effecter},
+            {commandIndex(pldmTypePlatform, 0x3A), &effecter},
+            {commandIndex(pldmTypePlatform, 0x51), &getPdr},
+            {commandIndex(pldmTypeBios, 0x01), &getBiosTable}};
+
+    auto iter = layouts.find(command);
+    if (iter == layouts.end())
+    {
+        return none;
+    }
+    return *iter->second;
+}
+
+bool PldmKeyIndex::add(const json& key, size_t id)
+{
+    uint8_t type = key.at("pldm-type").get<uint8_t>() & pldmTypeMask;
+    uint16_t index = commandIndex(type, key.at("command").get<uint8_t>());
+    const std::vector<Field>& fields = commandFields(index);
+
+    for (const char* name : {"sensor-id", "effecter-id", "record-handle",
+                             "transfer-flag", "table-type"})
+    {
+        if (key.contains(name) &&
+            std::none_of(fields.begin(), fields.end(), [name](const Field& f) {
+                return std::strcmp(f.name, name) == 0;
+            }))
+        {
+            return false;
+        }
+    }
+
+    // Every combination of the listed values
+    std::vector<uint64_t> values = {0};
+    unsigned given = 0;
+    size_t shift = 0;
+    for (size_t n = 0; n < fields.size(); n++)
+    {
+        const Field& field = fields[n];
+        if (key.contains(field.name))
+        {
+            const json& fieldValues = key[field.name];
+            std::vector<uint64_t> combined;
+            for (const auto& value : fieldValues.is_array()
+                                         ? fieldValues
+                                         : json::array({fieldValues}))
+            {
+                uint64_t bits = value.get<uint32_t>() &
+                                ((uint64_t{1} << (8 * field.width)) - 1);
+                for (uint64_t partial : values)
+                {
+                    combined.push_back(partial | bits << shift);
+                }
+            }
+            values = std::move(combined);
+            given |= 1U << n;
+        }
+        shift += 8 * field.width;
+    }
+
+    Command& command = commands.try_emplace(index, Command{&fields, {}})
+                           .first->second;
+    auto level = std::find_if(
+        command.levels.begin(), command.levels.end(),
+        [given](const Level& l) { return l.fields == given; });
+    if (level == command.levels.end())
+    {
+        command.levels.push_back(Level{given, {}});
+        std::sort(command.levels.begin(), command.levels.end(),
+                  [](const Level& a, const Level& b) {
+                      auto countA = std::bitset<32>(a.fields).count();
+                      auto countB = std::bitset<32>(b.fields).count();
+                      return countA != countB ? countA > countB
+                                              : a.fields < b.fields;
+                  });
+        level = std::find_if(
+            command.levels.begin(), command.levels.end(),
+            [given](const Level& l) { return l.fields == given; });
+    }
+    for (uint64_t value : values)
+    {
+        // Earlier entries win, as in the raw tables
+        level->entries.emplace(value, id);
+    }
+    return true;
+}
+
+std::optional<size_t> PldmKeyIndex::find(const uint8_t* request,
+                                         size_t size) const
+{
+    if (size < commandSize)
+    {
+        return std::nullopt;
+    }
+    auto command = commands.find(
+        commandIndex(request[0] & pldmTypeMask, request[1]));
+    if (command == commands.end())
+    {
+        return std::nullopt;
+    }
+
+    const std::vector<Field>& fields = *command->second.fields;
+    const uint8_t* data = request + commandSize;
+    size_t dataSize = size - commandSize;
+    for (const Level& level : command->second.levels)
+    {
+        uint64_t value = 0;
+        size_t shift = 0;
+        bool complete = true;
+        for (size_t n = 0; n < fields.size() && complete; n++)
+        {
+            const Field& field = fields[n];
+            if (level.fields & (1U << n))
+            {
+                complete = field.offset + field.width <= dataSize;
+                if (complete)
+                {
+                    value |= readLe(data + field.offset, field.width) << shift;
+                }
+            }
+            shift += 8 * field.width;
+        }
+        if (!complete)
+        {
+            continue;
+        }
+        auto entry = level.entries.find(value);
+        if (entry != level.entries.end())
+        {
+            return entry->second;
+        }
+    }
+    return std::nullopt;
+}
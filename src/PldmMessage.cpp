@@ -0,0 +1,44 @@
+#include "PldmMessage.hpp"
+
+#include "ByteOrder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr uint8_t pldmSensorEnabled = 0x00;
+constexpr uint8_t pldmNoEventGeneration = 0x00;
+constexpr uint8_t pldmSensorNormal = 0x01;
+
+bool isPldmRequest(const std::vector<uint8_t>& request, uint8_t pldmType)
+{
+    return request.size() >= pldmHeaderSize && (request[1] & pldmRequestBit) &&
+           (request[2] & pldmTypeMask) == pldmType;
+}
+
+std::vector<uint8_t> pldmResponseHeader(const std::vector<uint8_t>& request)
+{
+    return {request[0], static_cast<uint8_t>(request[1] & pldmInstanceIdMask),
+            request[2], request[3], pldmSuccess};
+}
+
+void appendPldmValue(std::vector<uint8_t>& out, uint8_t dataSize, double raw)
+{
+    size_t size = size_t{1} << (dataSize / 2);
+    bool isSigned = dataSize % 2;
+    double max = std::ldexp(1.0, static_cast<int>(8 * size - isSigned)) - 1;
+    double min = isSigned ? -max - 1 : 0;
+    auto value = std::isnan(raw) ? 0
+                                 : static_cast<int64_t>(
+                                       std::clamp(std::round(raw), min, max));
+    appendLe(out, static_cast<uint64_t>(value), size);
+}
+
+void appendSensorReading(std::vector<uint8_t>& out, uint8_t dataSize,
+                         double raw)
+{
+    // Operational, event message enable, present, previous and event state
+    out.insert(out.end(),
+               {dataSize, pldmSensorEnabled, pldmNoEventGeneration,
+                pldmSensorNormal, pldmSensorNormal, pldmSensorNormal});
+    appendPldmValue(out, dataSize, raw);
+}
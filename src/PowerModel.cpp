@@ -0,0 +1,110 @@
+#include "PowerModel.hpp"
+
+PowerModel::PowerModel(boost::asio::io_context& ioc,
+                       const Params& powerParams, StateHandler onStateChange) :
+    params(powerParams),
+    onChange(std::move(onStateChange)), stateTimer(ioc)
+{
+}
+
+PowerModel::~PowerModel()
+{
+    stateTimer.cancel();
+}
+
+void PowerModel::start()
+{
+    // Endpoints come up active and start idling right away
+    scheduleDrop();
+}
+
+std::string PowerModel::toString(State state)
+{
+    switch (state)
+    {
+        case State::active:
+            return "Active";
+        case State::idle:
+            return "Idle";
+        case State::lowPower:
+            return "LowPower";
+    }
+    return "Active";
+}
+
+void PowerModel::enter(State state)
+{
+    if (current == state)
+    {
+        return;
+    }
+    current = state;
+    onChange(current);
+}
+
+void PowerModel::scheduleDrop()
+{
+    std::chrono::milliseconds timeout{0};
+    State next = State::active;
+    if (current == State::active && params.idleTimeout.count() > 0)
+    {
+        timeout = params.idleTimeout;
+        next = State::idle;
+    }
+    else if (current != State::lowPower && params.lowPowerTimeout.count() > 0)
+    {
+        // Straight from active when there is no idle state
+        timeout = params.lowPowerTimeout;
+        next = State::lowPower;
+    }
+    else
+    {
+        return;
+    }
+
+    // A wait that completed just before it was cancelled still runs its
+    // handler without an error, the generation tells it is stale
+    uint64_t generation = ++timerGeneration;
+    stateTimer.expires_after(timeout);
+    stateTimer.async_wait([weak = weak_from_this(), next,
+                           generation](const boost::system::error_code& ec) {
+        auto self = weak.lock();
+        if (ec || !self || generation != self->timerGeneration)
+        {
+            // Woken by a request, or going away
+            return;
+        }
+        self->enter(next);
+        self->scheduleDrop();
+    });
+}
+
+std::chrono::milliseconds PowerModel::requestArrived()
+{
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::milliseconds penalty{0};
+    if (current == State::idle)
+    {
+        penalty = params.idleWakePenalty;
+    }
+    else if (current == State::lowPower)
+    {
+        penalty = params.lowPowerWakePenalty;
+    }
+
+    if (penalty.count() > 0)
+    {
+        wakingUntil = now + penalty;
+    }
+    else if (wakingUntil > now)
+    {
+        // Not awake yet, answered no earlier than the request that woke it
+        penalty =
+            std::chrono::ceil<std::chrono::milliseconds>(wakingUntil - now);
+    }
+
+    enter(State::active);
+    stateTimer.cancel();
+    scheduleDrop();
+    return penalty;
+}
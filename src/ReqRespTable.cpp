@@ -0,0 +1,148 @@
+#include "ReqRespTable.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+using json = nlohmann::json;
+
+CompiledTable::CompiledTable(const json& table, bool pldm)
+{
+    for (const auto& item : table)
+    {
+        std::vector<uint8_t> request;
+        std::vector<uint8_t> mask;
+        Entry entry{0, {}};
+        bool keyed = pldm && item.contains("command");
+        try
+        {
+            for (const auto& byte : item.value("request", json::array()))
+            {
+                // null matches any byte
+                request.push_back(byte.is_null() ? 0 : byte.get<uint8_t>());
+                mask.push_back(byte.is_null() ? 0x00 : 0xFF);
+            }
+            for (const auto& byte : item.value("response", json::array()))
+            {
+                entry.response.push_back(byte.get<uint8_t>());
+            }
+            entry.processingDelay = item.value("processing-delay", 0);
+            // Added last, the index refers to the entry by position
+            if (keyed && !keys.add(item, entries.size()))
+            {
+                std::cerr << "PLDM command " << item["command"]
+                          << " has no such key field\n";
+                continue;
+            }
+        }
+        catch (json::exception& e)
+        {
+            std::cerr << "message: " << e.what() << '\n'
+                      << "exception id: " << e.id << std::endl;
+            continue;
+        }
+        if (!keyed)
+        {
+            matcher.add(request, mask);
+            patternEntries.push_back(entries.size());
+        }
+        entries.push_back(std::move(entry));
+    }
+}
+
+const CompiledTable::Entry* CompiledTable::find(const uint8_t* data,
+                                                size_t size) const
+{
+    if (!keys.empty())
+    {
+        auto keyed = keys.find(data, size);
+        if (keyed)
+        {
+            return &entries[*keyed];
+        }
+    }
+    auto index = matcher.match(data, size);
+    if (!index)
+    {
+        return nullptr;
+    }
+    return &entries[patternEntries[*index]];
+}
+
+ReqRespFile::ReqRespFile(const json& document)
+{
+    std::vector<std::string> path;
+    compile(document, path);
+}
+
+void ReqRespFile::compile(const json& node, std::vector<std::string>& path)
+{
+    // Message type, vendor name, table key
+    constexpr size_t maxDepth = 3;
+    if (node.is_array() && !path.empty())
+    {
+        bool pldm = path.size() == 1 && path.front() == "PLDM";
+        tables.emplace(path, CompiledTable(node, pldm));
+        return;
+    }
+    if (!node.is_object() || path.size() == maxDepth)
+    {
+        return;
+    }
+    for (const auto& [key, child] : node.items())
+    {
+        path.push_back(key);
+        compile(child, path);
+        path.pop_back();
+    }
+}
+
+const CompiledTable*
+    ReqRespFile::table(const std::vector<std::string>& path) const
+{
+    auto iter = tables.find(path);
+    if (iter == tables.end())
+    {
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+std::shared_ptr<const ReqRespFile>
+    ReqRespCache::get(const std::string& fileName)
+{
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(fileName, ec);
+    if (ec)
+    {
+        std::cerr << "unable to open " << fileName << "\n";
+        return nullptr;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> readLock(lock);
+        auto iter = files.find(fileName);
+        if (iter != files.end() && iter->second.modified == modified)
+        {
+            return iter->second.file;
+        }
+    }
+
+    std::ifstream jsonFile(fileName);
+    if (!jsonFile.good())
+    {
+        std::cerr << "unable to open " << fileName << "\n";
+        return nullptr;
+    }
+    json document = json::parse(jsonFile, nullptr, false);
+    if (document.is_discarded())
+    {
+        std::cerr << "unable to parse " << fileName << "\n";
+        return nullptr;
+    }
+    auto file = std::make_shared<const ReqRespFile>(document);
+
+    std::unique_lock<std::shared_mutex> writeLock(lock);
+    files[fileName] = Cached{modified, file};
+    return file;
+}
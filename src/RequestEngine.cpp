@@ -0,0 +1,27 @@
+#include "RequestEngine.hpp"
+
+#include <limits>
+#include <phosphor-logging/log.hpp>
+#include <string>
+
+RequestEngine::RequestEngine(boost::asio::io_context& ioc, unsigned threads) :
+    ioContext(ioc), pool(threads)
+{
+    constexpr size_t eidCount = std::numeric_limits<mctp_eid_t>::max() + 1;
+    strands.reserve(eidCount);
+    for (size_t i = 0; i < eidCount; i++)
+    {
+        strands.emplace_back(boost::asio::make_strand(pool.get_executor()));
+    }
+
+    phosphor::logging::log<phosphor::logging::level::INFO>(
+        ("mctp-emulator: Request engine started with " +
+         std::to_string(threads) + " threads")
+            .c_str());
+}
+
+RequestEngine::~RequestEngine()
+{
+    pool.stop();
+    pool.join();
+}
@@ -0,0 +1,229 @@
+#include "RequestMatcher.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define MATCHER_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define MATCHER_NEON
+#endif
+
+namespace
+{
+
+// Rows of a block: the pattern bytes of all lanes, then their masks
+constexpr size_t rowSize = 2 * RequestMatcher::lanes;
+
+// Bit n set when lane n of the rows matches data. Lanes start out as in
+// used, and as the 0xFF bytes of initial for the vector versions.
+using BlockCompare = uint32_t (*)(const uint8_t* rows, size_t length,
+                                  const uint8_t* data, uint32_t used,
+                                  const uint8_t* initial);
+
+// Eight lanes per 64 bit word: a lane matches when its byte of
+// (broadcast data & mask) ^ value is zero
+uint32_t compareScalar(const uint8_t* rows, size_t length,
+                       const uint8_t* data, uint32_t used, const uint8_t*)
+{
+    constexpr uint64_t ones = 0x0101010101010101;
+    constexpr uint64_t low7 = 0x7F7F7F7F7F7F7F7F;
+    constexpr uint64_t high = 0x8080808080808080;
+    // Gathers the top bit of every byte into the top byte
+    constexpr uint64_t gather = 0x0102040810204080;
+
+    uint32_t matches = used;
+    for (size_t i = 0; i < length && matches != 0; i++, rows += rowSize)
+    {
+        uint64_t broadcast = data[i] * ones;
+        uint32_t rowMatches = 0;
+        for (size_t word = 0; word < RequestMatcher::lanes / 8; word++)
+        {
+            uint64_t value;
+            uint64_t mask;
+            std::memcpy(&value, rows + 8 * word, sizeof(value));
+            std::memcpy(&mask, rows + RequestMatcher::lanes + 8 * word,
+                        sizeof(mask));
+            uint64_t diff = (broadcast & mask) ^ value;
+            // High bit of each byte set where the byte is zero, exactly
+            uint64_t zero = ~(((diff & low7) + low7) | diff) & high;
+            rowMatches |= static_cast<uint32_t>(((zero >> 7) * gather) >> 56)
+                          << (8 * word);
+        }
+        matches &= rowMatches;
+    }
+    return matches;
+}
+
+#ifdef MATCHER_AVX2
+__attribute__((target("avx2"))) uint32_t
+    compareAvx2(const uint8_t* rows, size_t length, const uint8_t* data,
+                uint32_t, const uint8_t* initial)
+{
+    __m256i matches =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(initial));
+    for (size_t i = 0; i < length; i++, rows += rowSize)
+    {
+        __m256i broadcast = _mm256_set1_epi8(static_cast<char>(data[i]));
+        __m256i value =
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(rows));
+        __m256i mask = _mm256_load_si256(
+            reinterpret_cast<const __m256i*>(rows + RequestMatcher::lanes));
+        matches = _mm256_and_si256(
+            matches,
+            _mm256_cmpeq_epi8(_mm256_and_si256(broadcast, mask), value));
+        if (_mm256_testz_si256(matches, matches))
+        {
+            return 0;
+        }
+    }
+    return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+}
+#endif
+
+#ifdef MATCHER_NEON
+uint32_t compareNeon(const uint8_t* rows, size_t length, const uint8_t* data,
+                     uint32_t, const uint8_t* initial)
+{
+    static const uint8_t laneBits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                         1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t low = vld1q_u8(initial);
+    uint8x16_t high = vld1q_u8(initial + 16);
+    for (size_t i = 0; i < length; i++, rows += rowSize)
+    {
+        const uint8_t* mask = rows + RequestMatcher::lanes;
+        uint8x16_t broadcast = vdupq_n_u8(data[i]);
+        low = vandq_u8(low, vceqq_u8(vandq_u8(broadcast, vld1q_u8(mask)),
+                                     vld1q_u8(rows)));
+        high = vandq_u8(high,
+                        vceqq_u8(vandq_u8(broadcast, vld1q_u8(mask + 16)),
+                                 vld1q_u8(rows + 16)));
+        if (vmaxvq_u8(vorrq_u8(low, high)) == 0)
+        {
+            return 0;
+        }
+    }
+    uint8x16_t bits = vld1q_u8(laneBits);
+    low = vandq_u8(low, bits);
+    high = vandq_u8(high, bits);
+    return uint32_t{vaddv_u8(vget_low_u8(low))} |
+           uint32_t{vaddv_u8(vget_high_u8(low))} << 8 |
+           uint32_t{vaddv_u8(vget_low_u8(high))} << 16 |
+           uint32_t{vaddv_u8(vget_high_u8(high))} << 24;
+}
+#endif
+
+struct Implementation
+{
+    BlockCompare compare;
+    const char* name;
+};
+
+Implementation selectImplementation()
+{
+#ifdef MATCHER_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {compareAvx2, "avx2"};
+    }
+#endif
+#ifdef MATCHER_NEON
+    return {compareNeon, "neon"};
+#else
+    return {compareScalar, "scalar"};
+#endif
+}
+
+const Implementation& implementationInUse()
+{
+    static const Implementation selected = selectImplementation();
+    return selected;
+}
+
+} // namespace
+
+const char* RequestMatcher::implementation()
+{
+    return implementationInUse().name;
+}
+
+void RequestMatcher::add(const std::vector<uint8_t>& bytes,
+                         const std::vector<uint8_t>& mask)
+{
+    size_t id = count++;
+    size_t length = bytes.size();
+    if (length > maxBlockLength)
+    {
+        Pattern pattern{id, bytes, mask};
+        for (size_t i = 0; i < length; i++)
+        {
+            pattern.value[i] &= mask[i];
+        }
+        longPatterns[length].push_back(std::move(pattern));
+        return;
+    }
+
+    auto& lengthBlocks = blocks[length];
+    if (lengthBlocks.empty() || lengthBlocks.back().used == 0xFFFFFFFF)
+    {
+        lengthBlocks.emplace_back().rows.resize(length);
+    }
+    Block& block = lengthBlocks.back();
+    size_t lane = 0;
+    while (block.used & (1U << lane))
+    {
+        lane++;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        block.rows[i].value[lane] = bytes[i] & mask[i];
+        block.rows[i].mask[lane] = mask[i];
+    }
+    block.ids[lane] = id;
+    block.used |= 1U << lane;
+    block.initial[lane] = 0xFF;
+}
+
+std::optional<size_t> RequestMatcher::match(const uint8_t* data,
+                                            size_t size) const
+{
+    if (size <= maxBlockLength)
+    {
+        static_assert(sizeof(Row) == rowSize);
+        BlockCompare compare = implementationInUse().compare;
+        // Blocks fill in order, so the first block with a hit holds the
+        // first match and its lowest lane is the earliest pattern
+        for (const Block& block : blocks[size])
+        {
+            uint32_t matches =
+                compare(reinterpret_cast<const uint8_t*>(block.rows.data()),
+                        size, data, block.used, block.initial.data());
+            if (matches != 0)
+            {
+                return block.ids[static_cast<size_t>(
+                    __builtin_ctz(matches))];
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto patterns = longPatterns.find(size);
+    if (patterns == longPatterns.end())
+    {
+        return std::nullopt;
+    }
+    for (const Pattern& pattern : patterns->second)
+    {
+        size_t i = 0;
+        while (i < size && (data[i] & pattern.mask[i]) == pattern.value[i])
+        {
+            i++;
+        }
+        if (i == size)
+        {
+            return pattern.id;
+        }
+    }
+    return std::nullopt;
+}
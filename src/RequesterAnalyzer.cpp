@@ -0,0 +1,202 @@
+#include "RequesterAnalyzer.hpp"
+
+#include "PldmMessage.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <phosphor-logging/log.hpp>
+#include <string_view>
+
+#include "libmctp-msgtypes.h"
+
+RequesterAnalyzer::RequesterAnalyzer(boost::asio::io_context& ioc) :
+    summaryTimer(ioc)
+{
+    scheduleSummary();
+}
+
+void RequesterAnalyzer::setLimits(std::chrono::milliseconds requestTimeout,
+                                  size_t maxOutstanding)
+{
+    defaultTimeout = requestTimeout;
+    outstandingLimit = maxOutstanding;
+}
+
+RequesterAnalyzer::Client& RequesterAnalyzer::client(const std::string& sender,
+                                                     Clock::time_point now)
+{
+    auto iter = clients.find(sender);
+    if (iter == clients.end())
+    {
+        if (clients.size() >= maxClients)
+        {
+            // Unique names are never reused, drop the longest idle client
+            clients.erase(std::min_element(
+                clients.begin(), clients.end(), [](auto& lhs, auto& rhs) {
+                    return lhs.second.lastSeen < rhs.second.lastSeen;
+                }));
+        }
+        iter = clients.emplace(sender, Client{}).first;
+    }
+    iter->second.lastSeen = now;
+    return iter->second;
+}
+
+RequesterAnalyzer::RequestHandle
+    RequesterAnalyzer::requestStarted(const std::string& sender,
+                                      mctp_eid_t eid,
+                                      const std::vector<uint8_t>& payload)
+{
+    return requestStarted(sender, eid, payload, defaultTimeout);
+}
+
+RequesterAnalyzer::RequestHandle
+    RequesterAnalyzer::requestStarted(const std::string& sender,
+                                      mctp_eid_t eid,
+                                      const std::vector<uint8_t>& payload,
+                                      std::chrono::milliseconds timeout)
+{
+    auto now = Clock::now();
+    Client& stats = client(sender, now);
+    stats.total.requests++;
+
+    Request request;
+    request.seq = nextSeq++;
+    request.senderHash = std::hash<std::string>{}(sender);
+    request.payloadHash = std::hash<std::string_view>{}(std::string_view(
+        reinterpret_cast<const char*>(payload.data()), payload.size()));
+    request.outstandingUntil = now + timeout;
+
+    if (payload.size() >= 2 && payload[0] == MCTP_MESSAGE_TYPE_PLDM &&
+        (payload[1] & pldmRequestBit))
+    {
+        request.instanceId = payload[1] & pldmInstanceIdMask;
+    }
+
+    auto& ring = history[eid];
+    size_t outstanding = 0;
+    bool retried = false;
+    bool reused = false;
+    // Oldest entry is the one recycled for this request
+    size_t slot = 0;
+    for (size_t i = 0; i < ring.size(); i++)
+    {
+        const Request& previous = ring[i];
+        if (previous.seq < ring[slot].seq)
+        {
+            slot = i;
+        }
+        if (previous.seq == 0 || previous.outstandingUntil <= now)
+        {
+            continue;
+        }
+
+        outstanding++;
+        if (previous.senderHash != request.senderHash)
+        {
+            continue;
+        }
+        if (previous.payloadHash == request.payloadHash)
+        {
+            retried = true;
+        }
+        else if (request.instanceId >= 0 &&
+                 previous.instanceId == request.instanceId)
+        {
+            reused = true;
+        }
+    }
+
+    if (retried)
+    {
+        stats.total.earlyRetries++;
+    }
+    if (reused)
+    {
+        stats.total.instanceIdReuse++;
+    }
+    if (outstanding >= outstandingLimit)
+    {
+        stats.total.overSubscribed++;
+    }
+
+    ring[slot] = request;
+    return RequestHandle{eid, slot, request.seq};
+}
+
+void RequesterAnalyzer::responseScheduled(const RequestHandle& handle,
+                                          std::chrono::milliseconds after)
+{
+    auto ring = history.find(handle.eid);
+    if (ring == history.end())
+    {
+        return;
+    }
+    Request& request = ring->second[handle.slot];
+    if (request.seq != handle.seq)
+    {
+        // Already recycled
+        return;
+    }
+    request.outstandingUntil =
+        std::min(request.outstandingUntil, Clock::now() + after);
+}
+
+std::vector<RequesterAnalyzer::ClientStats> RequesterAnalyzer::getStats() const
+{
+    std::vector<ClientStats> stats;
+    stats.reserve(clients.size());
+    for (const auto& [sender, entry] : clients)
+    {
+        stats.emplace_back(sender, entry.total.requests,
+                           entry.total.instanceIdReuse,
+                           entry.total.earlyRetries,
+                           entry.total.overSubscribed);
+    }
+    return stats;
+}
+
+void RequesterAnalyzer::resetStats()
+{
+    clients.clear();
+}
+
+void RequesterAnalyzer::scheduleSummary()
+{
+    summaryTimer.expires_after(summaryInterval);
+    summaryTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        logSummary();
+        scheduleSummary();
+    });
+}
+
+void RequesterAnalyzer::logSummary()
+{
+    for (auto& [sender, entry] : clients)
+    {
+        uint64_t reuse =
+            entry.total.instanceIdReuse - entry.reported.instanceIdReuse;
+        uint64_t retries =
+            entry.total.earlyRetries - entry.reported.earlyRetries;
+        uint64_t overSubscribed =
+            entry.total.overSubscribed - entry.reported.overSubscribed;
+        uint64_t requests = entry.total.requests - entry.reported.requests;
+        entry.reported = entry.total;
+        if (reuse == 0 && retries == 0 && overSubscribed == 0)
+        {
+            continue;
+        }
+
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            ("mctp-emulator: Requester " + sender + " sent " +
+             std::to_string(requests) + " requests with " +
+             std::to_string(reuse) + " PLDM instance ID reuses, " +
+             std::to_string(retries) + " early retries and " +
+             std::to_string(overSubscribed) + " over-subscribed requests")
+                .c_str());
+    }
+}
@@ -0,0 +1,221 @@
+#include "TimeSeries.hpp"
+
+#include "PldmMessage.hpp"
+
+#include <endian.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+constexpr uint32_t timeSeriesVersion = 1;
+
+static uint64_t load64(const uint8_t* data)
+{
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return le64toh(value);
+}
+
+static uint32_t load32(const uint8_t* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return le32toh(value);
+}
+
+static double loadDouble(const uint8_t* data)
+{
+    uint64_t bits = load64(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+TimeSeries::TimeSeries(const std::string& fileName)
+{
+    int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "open " + fileName);
+    }
+    struct stat status = {};
+    if (::fstat(fd, &status) < 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "stat " + fileName);
+    }
+    mapSize = static_cast<size_t>(status.st_size);
+    void* mapped = mapSize >= headerSize
+                       ? ::mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0)
+                       : MAP_FAILED;
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        throw std::runtime_error(fileName + " is not a time series");
+    }
+    map = static_cast<const uint8_t*>(mapped);
+
+    // Unmaps again when the contents don't check out
+    auto invalid = [this, &fileName](const std::string& reason) {
+        ::munmap(const_cast<uint8_t*>(map), mapSize);
+        return std::runtime_error(fileName + ": " + reason);
+    };
+
+    if (std::memcmp(map, "MTSR", 4) != 0 ||
+        load32(map + 4) != timeSeriesVersion)
+    {
+        throw invalid("not a version 1 time series");
+    }
+    uint64_t columnCount = load32(map + 8);
+    rows = load64(map + 16);
+    // Divided rather than multiplied out, a corrupt header can't overflow
+    uint64_t dataSize = mapSize - headerSize - columnCount * nameSize;
+    uint64_t words = dataSize / sizeof(uint64_t);
+    if (columnCount > (mapSize - headerSize) / nameSize ||
+        dataSize % sizeof(uint64_t) != 0 || rows == 0 ||
+        words % (columnCount + 1) != 0 || words / (columnCount + 1) != rows)
+    {
+        throw invalid("size does not match its rows and columns");
+    }
+
+    const uint8_t* names = map + headerSize;
+    timestamps = names + columnCount * nameSize;
+    for (size_t i = 0; i < columnCount; i++)
+    {
+        const char* name = reinterpret_cast<const char*>(names + i * nameSize);
+        columnIndex.emplace(std::string(name, strnlen(name, nameSize)), i);
+        columns.push_back(timestamps + (i + 1) * rows * sizeof(uint64_t));
+    }
+    for (uint64_t row = 1; row < rows; row++)
+    {
+        if (timestamp(row) < timestamp(row - 1))
+        {
+            throw invalid("timestamps are not in order");
+        }
+    }
+}
+
+TimeSeries::~TimeSeries()
+{
+    ::munmap(const_cast<uint8_t*>(map), mapSize);
+}
+
+int64_t TimeSeries::timestamp(uint64_t row) const
+{
+    return static_cast<int64_t>(load64(timestamps + row * sizeof(uint64_t)));
+}
+
+std::optional<size_t> TimeSeries::column(const std::string& name) const
+{
+    auto iter = columnIndex.find(name);
+    if (iter == columnIndex.end())
+    {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+double TimeSeries::value(size_t column, std::chrono::microseconds time,
+                         End end) const
+{
+    const uint8_t* values = columns.at(column);
+    int64_t first = timestamp(0);
+    int64_t length = timestamp(rows - 1) - first;
+    int64_t offset = std::max<int64_t>(time.count(), 0);
+    if (end == End::loop && length > 0)
+    {
+        offset %= length;
+    }
+    int64_t at = first + std::min(offset, length);
+
+    // First row past the requested time
+    uint64_t low = 0;
+    uint64_t high = rows;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (timestamp(middle) <= at)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == rows)
+    {
+        return loadDouble(values + (rows - 1) * sizeof(uint64_t));
+    }
+    // The first sample is at or before any requested time
+    uint64_t after = low;
+    uint64_t before = after - 1;
+    double from = loadDouble(values + before * sizeof(uint64_t));
+    double to = loadDouble(values + after * sizeof(uint64_t));
+    double span = static_cast<double>(timestamp(after) - timestamp(before));
+    double share = static_cast<double>(at - timestamp(before)) / span;
+    return from + (to - from) * share;
+}
+
+PldmTimeSeriesResponder::PldmTimeSeriesResponder(
+    std::shared_ptr<const TimeSeries> timeSeries,
+    const Params& responderParams) :
+    series(std::move(timeSeries)),
+    params(responderParams), start(std::chrono::steady_clock::now())
+{
+    for (size_t i = 0; i < params.sensors.size(); i++)
+    {
+        sensorIndex.emplace(params.sensors[i].id, i);
+    }
+}
+
+bool PldmTimeSeriesResponder::handles(
+    const std::vector<uint8_t>& request) const
+{
+    if (!isPldmRequest(request, pldmTypePlatform) ||
+        request.size() < pldmHeaderSize + 2 ||
+        request[3] != pldmGetSensorReading)
+    {
+        return false;
+    }
+    uint16_t id = static_cast<uint16_t>(request[4] | request[5] << 8);
+    return sensorIndex.contains(id);
+}
+
+std::optional<MctpResponse>
+    PldmTimeSeriesResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (!handles(request))
+    {
+        return std::nullopt;
+    }
+
+    uint16_t id = static_cast<uint16_t>(request[4] | request[5] << 8);
+    const Sensor& sensor = params.sensors[sensorIndex.at(id)];
+    std::vector<uint8_t> out = pldmResponseHeader(request);
+    // sensorID and rearmEventState
+    if (request.size() != pldmHeaderSize + 3)
+    {
+        out[4] = pldmErrorInvalidLength;
+        return MctpResponse{params.processingDelay, out, nullptr};
+    }
+
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    auto time = std::chrono::microseconds(
+        static_cast<int64_t>(elapsed.count() * params.speed));
+    double value = series->value(sensor.column, time, params.end);
+    appendSensorReading(out, sensor.dataSize,
+                        (value - sensor.offset) / sensor.resolution);
+    return MctpResponse{params.processingDelay, out, nullptr};
+}
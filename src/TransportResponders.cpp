@@ -0,0 +1,53 @@
+#include "TransportResponders.hpp"
+
+#include "IntegrityPayload.hpp"
+
+#include <algorithm>
+
+std::optional<MctpResponse>
+    EchoResponder::respond(const std::vector<uint8_t>& request)
+{
+    return MctpResponse{delay, request, {}};
+}
+
+// Response size asked for by a sized request
+static size_t requestedSize(const std::vector<uint8_t>& request)
+{
+    if (request.size() < 5)
+    {
+        return request.size();
+    }
+    return size_t{request[1]} | size_t{request[2]} << 8 |
+           size_t{request[3]} << 16 | size_t{request[4]} << 24;
+}
+
+std::optional<MctpResponse>
+    SizedResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (request.empty())
+    {
+        return std::nullopt;
+    }
+
+    size_t size =
+        std::clamp<size_t>(requestedSize(request), 1, maxResponseSize);
+
+    std::vector<uint8_t> response(size, 0);
+    response[0] = request[0];
+    return MctpResponse{delay, std::move(response), {}};
+}
+
+std::optional<MctpResponse>
+    IntegrityResponder::respond(const std::vector<uint8_t>& request)
+{
+    if (request.empty())
+    {
+        return std::nullopt;
+    }
+
+    size_t size = std::clamp<size_t>(requestedSize(request),
+                                     IntegrityPayload::minSize,
+                                     SizedResponder::maxResponseSize);
+    return MctpResponse{
+        delay, IntegrityPayload::make(request[0], sequence++, size), {}};
+}
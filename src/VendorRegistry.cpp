@@ -0,0 +1,222 @@
+#include "VendorRegistry.hpp"
+
+#include <phosphor-logging/log.hpp>
+
+#include "libmctp-msgtypes.h"
+#include "libmctp-vdpci.h"
+
+VendorRegistry vendorRegistry;
+
+// Intel VDMs carry a fixed 0x80 byte and a vendor type code selecting the
+// sub table
+static std::optional<VendorRegistry::Header>
+    parseIntelHeader(const std::vector<uint8_t>& payload)
+{
+    constexpr uint8_t intelReserved = 0x80;
+
+    if (payload.size() < sizeof(mctp_vdpci_intel_hdr))
+    {
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            "mctp-emulator: Invalid VDPCI message: Insufficient bytes in "
+            "Payload");
+        return std::nullopt;
+    }
+
+    const auto* vdpciMessage =
+        reinterpret_cast<const mctp_vdpci_intel_hdr*>(payload.data());
+    if (vdpciMessage->reserved != intelReserved)
+    {
+        phosphor::logging::log<phosphor::logging::level::WARNING>(
+            "mctp-emulator: Invalid VDPCI message: Unexpected value in "
+            "reserved byte");
+        return std::nullopt;
+    }
+    return VendorRegistry::Header{
+        sizeof(mctp_vdpci_intel_hdr),
+        std::to_string(vdpciMessage->vendor_type_code)};
+}
+
+// Message type byte followed by the big endian vendor ID
+static size_t vendorIdEnd(VendorRegistry::Space space)
+{
+    return space == VendorRegistry::Space::pci ? 3 : 5;
+}
+
+VendorRegistry::VendorRegistry() : slots(16)
+{
+    add(Space::pci, 0x8086, "Intel", parseIntelHeader);
+}
+
+size_t VendorRegistry::slotOf(Space space, uint32_t id) const
+{
+    uint64_t key = (static_cast<uint64_t>(space) << 32) | id;
+    // Fibonacci hashing, slots.size() is a power of two
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) &
+           (slots.size() - 1);
+}
+
+void VendorRegistry::grow()
+{
+    std::vector<Vendor> old(slots.size() * 2);
+    std::swap(old, slots);
+    used = 0;
+    for (auto& vendor : old)
+    {
+        if (!vendor.name.empty())
+        {
+            add(vendor.space, vendor.id, std::move(vendor.name),
+                std::move(vendor.parser));
+        }
+    }
+}
+
+void VendorRegistry::add(Space space, uint32_t id, std::string name,
+                         Parser parser)
+{
+    // Keep at least half of the slots free for short probe sequences
+    if ((used + 1) * 2 > slots.size())
+    {
+        grow();
+    }
+    if (!parser)
+    {
+        parser = [space](const std::vector<uint8_t>& payload)
+            -> std::optional<Header> {
+            if (payload.size() < vendorIdEnd(space))
+            {
+                return std::nullopt;
+            }
+            return Header{vendorIdEnd(space), {}};
+        };
+    }
+
+    size_t slot = slotOf(space, id);
+    while (!slots[slot].name.empty())
+    {
+        if (slots[slot].space == space && slots[slot].id == id)
+        {
+            slots[slot].name = std::move(name);
+            slots[slot].parser = std::move(parser);
+            return;
+        }
+        slot = (slot + 1) & (slots.size() - 1);
+    }
+    slots[slot] = Vendor{space, id, std::move(name), std::move(parser)};
+    used++;
+}
+
+const VendorRegistry::Vendor* VendorRegistry::find(Space space,
+                                                   uint32_t id) const
+{
+    size_t slot = slotOf(space, id);
+    while (!slots[slot].name.empty())
+    {
+        if (slots[slot].space == space && slots[slot].id == id)
+        {
+            return &slots[slot];
+        }
+        slot = (slot + 1) & (slots.size() - 1);
+    }
+    return nullptr;
+}
+
+std::optional<std::pair<VendorRegistry::Space, uint32_t>>
+    VendorRegistry::vendorOf(const std::vector<uint8_t>& payload)
+{
+    if (payload.empty())
+    {
+        return std::nullopt;
+    }
+
+    Space space;
+    if (payload[0] == MCTP_MESSAGE_TYPE_VDPCI)
+    {
+        space = Space::pci;
+    }
+    else if (payload[0] == MCTP_MESSAGE_TYPE_VDIANA)
+    {
+        space = Space::iana;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    size_t end = vendorIdEnd(space);
+    if (payload.size() < end)
+    {
+        return std::nullopt;
+    }
+    uint32_t id = 0;
+    for (size_t i = 1; i < end; i++)
+    {
+        id = (id << 8) | payload[i];
+    }
+    return std::make_pair(space, id);
+}
+
+const VendorRegistry::Vendor*
+    VendorRegistry::identify(const std::vector<uint8_t>& payload) const
+{
+    auto vendor = vendorOf(payload);
+    if (!vendor)
+    {
+        return nullptr;
+    }
+    return find(vendor->first, vendor->second);
+}
+
+void VendorResponder::add(uint32_t id, std::shared_ptr<Responder> responder)
+{
+    for (auto& [vendorId, current] : vendors)
+    {
+        if (vendorId == id)
+        {
+            // A second responder of the vendor joins the first
+            auto chain = std::dynamic_pointer_cast<ResponderChain>(current);
+            if (!chain)
+            {
+                chain = std::make_shared<ResponderChain>();
+                chain->add(std::move(current));
+                current = chain;
+            }
+            chain->add(std::move(responder));
+            return;
+        }
+    }
+    vendors.emplace_back(id, std::move(responder));
+}
+
+Responder* VendorResponder::find(const std::vector<uint8_t>& request) const
+{
+    auto vendor = VendorRegistry::vendorOf(request);
+    if (!vendor)
+    {
+        return nullptr;
+    }
+    for (const auto& [vendorId, responder] : vendors)
+    {
+        if (vendorId == vendor->second)
+        {
+            return responder.get();
+        }
+    }
+    return nullptr;
+}
+
+bool VendorResponder::handles(const std::vector<uint8_t>& request) const
+{
+    Responder* responder = find(request);
+    return responder != nullptr && responder->handles(request);
+}
+
+std::optional<MctpResponse>
+    VendorResponder::respond(const std::vector<uint8_t>& request)
+{
+    Responder* responder = find(request);
+    if (responder == nullptr)
+    {
+        return std::nullopt;
+    }
+    return responder->respond(request);
+}
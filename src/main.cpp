@@ -1,3 +1,4 @@
+#include "ConfigWatcher.hpp"
 #include "OemBinding.hpp"
 
 #include <CLI/CLI.hpp>
@@ -43,6 +44,39 @@ int main()
 
     binding = jsonConfig["bindtype"];
 
+    // Threads processing requests, 0 picks one per core
+    unsigned workerThreads = jsonConfig.value("worker-threads", 0U);
+    // Threads generating CPU heavy responses, 0 picks one per core
+    unsigned computeThreads = jsonConfig.value("compute-threads", 0U);
+
+    // Vendors of vendor defined messages besides Intel, by PCI vendor ID or
+    // IANA enterprise number, e.g. "vendors": {"VDPCI": {"0x1D0F": "Acme"}}
+    if (jsonConfig.contains("vendors") && jsonConfig["vendors"].is_object())
+    {
+        const json& vendors = jsonConfig["vendors"];
+        for (const auto& [key, space] :
+             {std::make_pair("VDPCI", VendorRegistry::Space::pci),
+              std::make_pair("VDIANA", VendorRegistry::Space::iana)})
+        {
+            for (const auto& [id, name] :
+                 vendors.value(key, json::object()).items())
+            {
+                try
+                {
+                    vendorRegistry.add(
+                        space,
+                        static_cast<uint32_t>(std::stoul(id, nullptr, 0)),
+                        name.get<std::string>());
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "Skipping vendor " << id << ": " << e.what()
+                              << std::endl;
+                }
+            }
+        }
+    }
+
     boost::asio::io_context ioc;
     boost::asio::signal_set signals(ioc, SIGINT, SIGTERM);
     signals.async_wait(
@@ -67,16 +101,43 @@ int main()
     {
         val = bindType::pcie;
     }
+    else if (!binding.compare("i3c"))
+    {
+        val = bindType::i3c;
+    }
+    else if (!binding.compare("usb"))
+    {
+        val = bindType::usb;
+    }
+    else if (!binding.compare("kcs"))
+    {
+        val = bindType::kcs;
+    }
     else
     {
         // default binding incase not known/undefined.
         val = bindType::vendorDefined;
     }
 
-    OemBinding oemInstance(objectServer, mctpBaseObj, val);
+    // Link timing parameters live under the binding name, e.g. "i3c": {...}
+    OemBinding oemInstance(objectServer, mctpBaseObj, val, workerThreads,
+                           computeThreads,
+                           jsonConfig.value(binding, json::object()));
+
+    // How long requesters are assumed to wait for a response when the method
+    // call doesn't say, and how many requests one endpoint takes at once
+    oemInstance.setAnalyzerLimits(
+        std::chrono::milliseconds(
+            jsonConfig.value("analyzer-timeout-ms", 100U)),
+        jsonConfig.value("analyzer-max-outstanding", 8U));
 
     // Initialize endpoints using endpointDataFile json file
     oemInstance.addEndpoints(endpointDataFile);
+
+    // Apply edits of endpointDataFile as a diff against the live endpoints
+    ConfigWatcher endpointWatcher(ioc, endpointDataFile, [&oemInstance]() {
+        oemInstance.reloadEndpoints(endpointDataFile);
+    });
     ioc.run();
 
     return 0;